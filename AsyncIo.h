@@ -0,0 +1,673 @@
+#ifndef ASYNC_IO_H
+#define ASYNC_IO_H
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "ThreadPool.h"
+#include "Future.h"
+#include "DeadlineQueue.h"
+
+// =========================================
+// MODULE 10: Asynchronous I/O
+// =========================================
+// File and socket operations that never park a worker. Each call starts the
+// operation and returns a PoolFuture right away; chain .then() on it or
+// co_await it (C++20) and the continuation runs on the pool when the
+// operation finishes. Errors come out as std::system_error.
+//
+//     AsyncIo io(pool);
+//     io.recv(sock, buf, sizeof(buf))
+//         .then([&](long n) { return io.send(sock, buf, n); });
+//
+// Backend: io_uring through the raw syscalls (no liburing needed), or epoll
+// where io_uring is missing or blocked. With epoll the operations run
+// nonblocking once the fd is ready (fds are switched to O_NONBLOCK, and
+// regular files, which epoll can't watch, are read and written directly).
+//
+// One thread sleeps in the kernel until completions arrive and then hands
+// them to the pool as a single drain task, which completes the whole batch
+// on a worker; it waits for that drain before sleeping again. Destroy the
+// AsyncIo before its ThreadPool. Operations still in flight then fail with
+// ECANCELED, and their buffers must stay valid until that happens.
+class AsyncIo {
+public:
+    enum class Backend {
+        IoUring,
+        Epoll
+    };
+
+private:
+    enum class OpKind { Read, Write, Accept, Recv, Send, Timeout };
+
+    struct Op {
+        PoolPromise<long> promise;
+        OpKind kind;
+        int fd = -1;
+        void* buf = nullptr;
+        size_t len = 0;
+        int64_t offset = -1;
+        int flags = 0;
+        std::chrono::steady_clock::time_point deadline; // Timeout, epoll
+        __kernel_timespec ts{};                          // Timeout, io_uring (read by the kernel)
+
+        Op(ThreadPool* pool, OpKind k) : promise(pool), kind(k) {}
+    };
+
+    struct Completion {
+        Op* op;
+        long result;
+    };
+
+    static const char* op_name(OpKind kind) {
+        switch (kind) {
+        case OpKind::Read:    return "AsyncIo::read";
+        case OpKind::Write:   return "AsyncIo::write";
+        case OpKind::Accept:  return "AsyncIo::accept";
+        case OpKind::Recv:    return "AsyncIo::recv";
+        case OpKind::Send:    return "AsyncIo::send";
+        case OpKind::Timeout: return "AsyncIo::timeout";
+        }
+        return "AsyncIo";
+    }
+
+    ThreadPool& pool;
+    Backend kind;
+    std::atomic<bool> stopping{false};
+    std::thread waiter;
+
+    // Waiter -> drain task handoff
+    std::atomic<bool> draining{false};
+    WakeupSignal drained;
+    std::vector<Completion> batch;      // Only touched by the current drain
+
+    // Drain tasks posted and not finished yet; the destructor waits for them,
+    // since a drain still fulfils its batch after the waiter moved on
+    std::mutex drain_mtx;
+    std::condition_variable drain_cv;
+    size_t drains_running = 0;
+
+    std::mutex track_mtx;
+    std::unordered_set<Op*> outstanding;
+
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> batches{0};
+
+    Op* track(Op* op) {
+        std::lock_guard<std::mutex> lock(track_mtx);
+        outstanding.insert(op);
+        return op;
+    }
+
+    // Fulfil the future and free the op
+    void complete(Op* op, long result) {
+        {
+            std::lock_guard<std::mutex> lock(track_mtx);
+            if (outstanding.erase(op) == 0) return; // Already failed by the destructor
+        }
+        if (op->kind == OpKind::Timeout && (result == -ETIME || result == 0)) {
+            op->promise.set_value(0);
+        } else if (result < 0) {
+            op->promise.set_exception(std::make_exception_ptr(
+                std::system_error((int)-result, std::generic_category(), op_name(op->kind))));
+        } else {
+            op->promise.set_value(result);
+        }
+        delete op;
+        completed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Posted by the waiter; drains everything that is ready in one go
+    class DrainTask {
+    private:
+        AsyncIo* io;
+
+    public:
+        explicit DrainTask(AsyncIo* i) : io(i) {}
+
+        void operator()() {
+            io->drain();
+        }
+
+        // Dropped by the pool: drain here rather than leave the waiter stuck
+        void fail(std::exception_ptr) {
+            io->drain();
+        }
+    };
+
+    void drain() {
+        batch.clear();
+        if (kind == Backend::IoUring) {
+            reap_ring();
+        } else {
+            reap_ready();
+        }
+        batches.fetch_add(1, std::memory_order_relaxed);
+        std::vector<Completion> done;
+        done.swap(batch);
+
+        // Let the waiter go back to the kernel while we fulfil the batch
+        draining.store(false, std::memory_order_release);
+        drained.notify_all();
+        for (const Completion& c : done) complete(c.op, c.result);
+
+        std::lock_guard<std::mutex> lock(drain_mtx);
+        if (--drains_running == 0) drain_cv.notify_all();
+    }
+
+    // Hand the ready completions to a worker and wait until it took them
+    void hand_off() {
+        {
+            std::lock_guard<std::mutex> lock(drain_mtx);
+            ++drains_running;
+        }
+        draining.store(true, std::memory_order_release);
+        pool.post(DrainTask(this));
+        while (true) {
+            uint32_t seen = drained.prepare();
+            if (!draining.load(std::memory_order_acquire)) break;
+            drained.wait(seen);
+        }
+    }
+
+    // =========================================
+    // io_uring backend
+    // =========================================
+    int ring_fd = -1;
+    void* sq_ring = MAP_FAILED;
+    size_t sq_ring_size = 0;
+    void* cq_ring = MAP_FAILED;
+    size_t cq_ring_size = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqes_size = 0;
+    unsigned sq_entries = 0;
+    unsigned* sq_head = nullptr;
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_mask = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned* cq_mask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    std::mutex sq_mtx;
+
+    static int uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+        return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+    }
+
+    bool setup_ring(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ring_fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+        if (ring_fd < 0) return false;
+
+        sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+
+        sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+        if (sq_ring == MAP_FAILED) return false;
+        cq_ring = single_mmap ? sq_ring
+                              : mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+        if (cq_ring == MAP_FAILED) return false;
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqe_map = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+        if (sqe_map == MAP_FAILED) return false;
+        sqes = static_cast<io_uring_sqe*>(sqe_map);
+
+        char* sq = static_cast<char*>(sq_ring);
+        char* cq = static_cast<char*>(cq_ring);
+        sq_entries = params.sq_entries;
+        sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    void teardown_ring() {
+        if (sqes) munmap(sqes, sqes_size);
+        if (cq_ring != MAP_FAILED && cq_ring != sq_ring) munmap(cq_ring, cq_ring_size);
+        if (sq_ring != MAP_FAILED) munmap(sq_ring, sq_ring_size);
+        if (ring_fd >= 0) close(ring_fd);
+        sqes = nullptr;
+        sq_ring = cq_ring = MAP_FAILED;
+        ring_fd = -1;
+    }
+
+    // Fill one SQE and submit everything pending. user_data 0 is the waiter's wake-up NOP.
+    long ring_submit(Op* op) {
+        std::lock_guard<std::mutex> lock(sq_mtx);
+        unsigned tail = *sq_tail;
+        unsigned head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+        if (tail - head >= sq_entries) return -EBUSY;
+
+        unsigned index = tail & *sq_mask;
+        io_uring_sqe& sqe = sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.user_data = reinterpret_cast<uint64_t>(op);
+
+        if (op == nullptr) {
+            sqe.opcode = IORING_OP_NOP;
+        } else {
+            sqe.fd = op->fd;
+            sqe.addr = reinterpret_cast<uint64_t>(op->buf);
+            sqe.len = (uint32_t)op->len;
+            switch (op->kind) {
+            case OpKind::Read:
+                sqe.opcode = IORING_OP_READ;
+                sqe.off = (uint64_t)op->offset;    // -1: current file position
+                break;
+            case OpKind::Write:
+                sqe.opcode = IORING_OP_WRITE;
+                sqe.off = (uint64_t)op->offset;
+                break;
+            case OpKind::Accept:
+                sqe.opcode = IORING_OP_ACCEPT;
+                sqe.addr = 0;
+                sqe.len = 0;
+                sqe.accept_flags = SOCK_CLOEXEC;
+                break;
+            case OpKind::Recv:
+                sqe.opcode = IORING_OP_RECV;
+                sqe.msg_flags = (uint32_t)op->flags;
+                break;
+            case OpKind::Send:
+                sqe.opcode = IORING_OP_SEND;
+                sqe.msg_flags = (uint32_t)(op->flags | MSG_NOSIGNAL);
+                break;
+            case OpKind::Timeout:
+                sqe.opcode = IORING_OP_TIMEOUT;
+                sqe.fd = -1;
+                sqe.addr = reinterpret_cast<uint64_t>(&op->ts);
+                sqe.len = 1;
+                break;
+            }
+        }
+
+        sq_array[index] = index;
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+        // Submit everything the kernel hasn't taken yet (a short submit leaves SQEs behind)
+        int ret = uring_enter(ring_fd, tail + 1 - head, 0, 0);
+        if (ret >= 0) return 0;
+        long error = -errno;
+
+        // Failed: unless the kernel took our SQE anyway, unpublish it, so the
+        // caller can fail the Op without a later enter submitting freed memory
+        unsigned taken = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) - head;
+        if (taken > tail - head) return 0; // In flight: its CQE completes the Op
+        __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+        return error;
+    }
+
+    bool ring_has_completions() {
+        return __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE) != *cq_head;
+    }
+
+    void reap_ring() {
+        unsigned head = *cq_head;
+        unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = cqes[head & *cq_mask];
+            if (cqe.user_data != 0) {
+                batch.push_back(Completion{reinterpret_cast<Op*>(cqe.user_data), (long)cqe.res});
+            }
+        }
+        __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    void ring_loop() {
+        while (!stopping.load(std::memory_order_acquire)) {
+            if (!ring_has_completions()) {
+                uring_enter(ring_fd, 0, 1, IORING_ENTER_GETEVENTS); // EINTR: just look again
+                continue;
+            }
+            hand_off();
+        }
+    }
+
+    // =========================================
+    // epoll backend
+    // =========================================
+    struct FdWaiters {
+        std::vector<Op*> readers;       // FIFO: read, recv, accept
+        std::vector<Op*> writers;       // FIFO: write, send
+    };
+
+    int epoll_fd = -1;
+    int wake_fd = -1;                   // eventfd: new timer or shutdown
+    std::mutex fd_mtx;
+    std::unordered_map<int, FdWaiters> fds;
+    DeadlineQueue<Op*> timers;
+    std::vector<epoll_event> ready;     // Filled by the waiter, read by the drain
+
+    static constexpr uint64_t kWakeTag = ~0ull;
+
+    bool setup_epoll() {
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (epoll_fd < 0 || wake_fd < 0) return false;
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = kWakeTag;
+        return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &ev) == 0;
+    }
+
+    void teardown_epoll() {
+        if (wake_fd >= 0) close(wake_fd);
+        if (epoll_fd >= 0) close(epoll_fd);
+        wake_fd = epoll_fd = -1;
+    }
+
+    void wake_waiter() {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(wake_fd, &one, sizeof(one));
+        (void)ignored;
+    }
+
+    static bool is_reader(OpKind kind) {
+        return kind == OpKind::Read || kind == OpKind::Accept || kind == OpKind::Recv;
+    }
+
+    // The syscall itself, nonblocking; -errno on failure
+    static long perform(Op* op) {
+        long r = -1;
+        switch (op->kind) {
+        case OpKind::Read:
+            r = op->offset < 0 ? ::read(op->fd, op->buf, op->len) : ::pread(op->fd, op->buf, op->len, op->offset);
+            break;
+        case OpKind::Write:
+            r = op->offset < 0 ? ::write(op->fd, op->buf, op->len) : ::pwrite(op->fd, op->buf, op->len, op->offset);
+            break;
+        case OpKind::Accept:
+            r = ::accept4(op->fd, nullptr, nullptr, SOCK_CLOEXEC);
+            break;
+        case OpKind::Recv:
+            r = ::recv(op->fd, op->buf, op->len, op->flags | MSG_DONTWAIT);
+            break;
+        case OpKind::Send:
+            r = ::send(op->fd, op->buf, op->len, op->flags | MSG_DONTWAIT | MSG_NOSIGNAL);
+            break;
+        case OpKind::Timeout:
+            r = 0;
+            break;
+        }
+        return r < 0 ? -errno : r;
+    }
+
+    // Caller holds fd_mtx. Watch exactly what the queued ops need.
+    void update_interest(int fd, FdWaiters& w, bool registered) {
+        if (w.readers.empty() && w.writers.empty()) {
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+            fds.erase(fd);
+            return;
+        }
+        epoll_event ev{};
+        ev.events = (w.readers.empty() ? 0u : uint32_t(EPOLLIN)) | (w.writers.empty() ? 0u : uint32_t(EPOLLOUT));
+        ev.data.fd = fd;
+        epoll_ctl(epoll_fd, registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    long epoll_submit(Op* op) {
+        if (op->kind == OpKind::Timeout) {
+            timers.push(op->deadline, op);
+            wake_waiter();              // Its wait may need to end sooner now
+            return 0;
+        }
+
+        std::unique_lock<std::mutex> lock(fd_mtx);
+        auto found = fds.find(op->fd);
+        if (found == fds.end()) {
+            epoll_event ev{};
+            ev.events = is_reader(op->kind) ? EPOLLIN : EPOLLOUT;
+            ev.data.fd = op->fd;
+            int flags = fcntl(op->fd, F_GETFL);
+            if (flags >= 0 && !(flags & O_NONBLOCK)) fcntl(op->fd, F_SETFL, flags | O_NONBLOCK);
+            if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, op->fd, &ev) < 0) {
+                int error = errno;
+                lock.unlock();
+                // Regular files are always "ready": just do it
+                if (error == EPERM) {
+                    complete(op, perform(op));
+                    return 0;
+                }
+                return -error;
+            }
+            FdWaiters& w = fds[op->fd];
+            (is_reader(op->kind) ? w.readers : w.writers).push_back(op);
+            return 0;
+        }
+
+        FdWaiters& w = found->second;
+        (is_reader(op->kind) ? w.readers : w.writers).push_back(op);
+        update_interest(op->fd, w, true);
+        return 0;
+    }
+
+    // Run the ops queued on one ready fd, in order, until one would block
+    void run_ready(int fd, uint32_t events) {
+        std::lock_guard<std::mutex> lock(fd_mtx);
+        auto found = fds.find(fd);
+        if (found == fds.end()) return;
+        FdWaiters& w = found->second;
+
+        auto run_queue = [&](std::vector<Op*>& queue) {
+            size_t done = 0;
+            for (; done < queue.size(); ++done) {
+                long r = perform(queue[done]);
+                if (r == -EAGAIN || r == -EWOULDBLOCK) break;
+                batch.push_back(Completion{queue[done], r});
+            }
+            queue.erase(queue.begin(), queue.begin() + done);
+        };
+        if (events & (EPOLLIN | EPOLLERR | EPOLLHUP)) run_queue(w.readers);
+        if (events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) run_queue(w.writers);
+        update_interest(fd, w, true);
+    }
+
+    void reap_ready() {
+        for (const epoll_event& ev : ready) run_ready(ev.data.fd, ev.events);
+        ready.clear();
+
+        auto now = DeadlineQueue<Op*>::Clock::now();
+        DeadlineQueue<Op*>::Clock::time_point deadline;
+        Op* op;
+        while (timers.next_deadline(deadline) && deadline <= now && timers.pop(op, deadline)) {
+            batch.push_back(Completion{op, 0});
+        }
+    }
+
+    void epoll_loop() {
+        std::vector<epoll_event> events(256);
+        while (!stopping.load(std::memory_order_acquire)) {
+            int timeout_ms = -1;
+            DeadlineQueue<Op*>::Clock::time_point deadline;
+            if (timers.next_deadline(deadline)) {
+                auto wait = deadline - DeadlineQueue<Op*>::Clock::now();
+                timeout_ms = wait.count() <= 0 ? 0 : (int)std::chrono::ceil<std::chrono::milliseconds>(wait).count();
+            }
+
+            int n = epoll_wait(epoll_fd, events.data(), (int)events.size(), timeout_ms);
+            if (n < 0) continue;        // EINTR
+
+            for (int i = 0; i < n; ++i) {
+                if (events[i].data.u64 == kWakeTag) {
+                    uint64_t count;
+                    ssize_t ignored = ::read(wake_fd, &count, sizeof(count));
+                    (void)ignored;
+                } else {
+                    ready.push_back(events[i]);
+                }
+            }
+            bool timer_due = timers.next_deadline(deadline) && deadline <= DeadlineQueue<Op*>::Clock::now();
+            if (stopping.load(std::memory_order_acquire)) break;
+            if (ready.empty() && !timer_due) continue;
+            hand_off();
+        }
+    }
+
+    // =========================================
+
+    Op* make(OpKind k, int fd) {
+        Op* op = new Op(&pool, k);
+        op->fd = fd;
+        return op;
+    }
+
+    PoolFuture<long> start(Op* op) {
+        PoolFuture<long> result = op->promise.get_future();
+        track(op);
+        long error = kind == Backend::IoUring ? ring_submit(op) : epoll_submit(op);
+        if (error < 0) complete(op, error);
+        return result;
+    }
+
+public:
+    // entries: io_uring submission queue size (completion queue is twice that).
+    // force_epoll skips io_uring even where it works.
+    explicit AsyncIo(ThreadPool& p, unsigned entries = 1024, bool force_epoll = false) : pool(p) {
+        if (!force_epoll && setup_ring(entries)) {
+            kind = Backend::IoUring;
+            waiter = std::thread(&AsyncIo::ring_loop, this);
+            return;
+        }
+        teardown_ring();
+        if (!setup_epoll()) {
+            int error = errno;
+            teardown_epoll();
+            throw std::system_error(error, std::generic_category(), "AsyncIo: neither io_uring nor epoll");
+        }
+        kind = Backend::Epoll;
+        waiter = std::thread(&AsyncIo::epoll_loop, this);
+    }
+
+    AsyncIo(const AsyncIo&) = delete;
+    AsyncIo& operator=(const AsyncIo&) = delete;
+
+    ~AsyncIo() {
+        stopping.store(true, std::memory_order_release);
+        if (kind == Backend::IoUring) {
+            ring_submit(nullptr);       // Completes at once and wakes the waiter
+        } else {
+            wake_waiter();
+        }
+        if (waiter.joinable()) waiter.join();
+        {
+            std::unique_lock<std::mutex> lock(drain_mtx);
+            drain_cv.wait(lock, [this] { return drains_running == 0; });
+        }
+
+        // Whatever finished in the meantime still gets its real result
+        batch.clear();
+        if (kind == Backend::IoUring) {
+            reap_ring();
+        }
+        for (const Completion& c : batch) complete(c.op, c.result);
+
+        if (kind == Backend::IoUring) {
+            teardown_ring();            // Cancels what the kernel still has
+        } else {
+            teardown_epoll();
+        }
+
+        std::vector<Op*> left;
+        {
+            std::lock_guard<std::mutex> lock(track_mtx);
+            left.assign(outstanding.begin(), outstanding.end());
+        }
+        for (Op* op : left) complete(op, -ECANCELED);
+    }
+
+    Backend backend() const {
+        return kind;
+    }
+
+    // offset -1 reads at (and advances) the current file position; pipes and sockets ignore it
+    PoolFuture<long> read(int fd, void* buf, size_t len, int64_t offset = -1) {
+        Op* op = make(OpKind::Read, fd);
+        op->buf = buf;
+        op->len = len;
+        op->offset = offset;
+        return start(op);
+    }
+
+    PoolFuture<long> write(int fd, const void* buf, size_t len, int64_t offset = -1) {
+        Op* op = make(OpKind::Write, fd);
+        op->buf = const_cast<void*>(buf);
+        op->len = len;
+        op->offset = offset;
+        return start(op);
+    }
+
+    // Result: the accepted connection's fd
+    PoolFuture<long> accept(int listen_fd) {
+        return start(make(OpKind::Accept, listen_fd));
+    }
+
+    PoolFuture<long> recv(int fd, void* buf, size_t len, int flags = 0) {
+        Op* op = make(OpKind::Recv, fd);
+        op->buf = buf;
+        op->len = len;
+        op->flags = flags;
+        return start(op);
+    }
+
+    PoolFuture<long> send(int fd, const void* buf, size_t len, int flags = 0) {
+        Op* op = make(OpKind::Send, fd);
+        op->buf = const_cast<void*>(buf);
+        op->len = len;
+        op->flags = flags;
+        return start(op);
+    }
+
+    // Completes with 0 after 'delay', without holding any thread meanwhile
+    PoolFuture<long> timeout(std::chrono::nanoseconds delay) {
+        Op* op = make(OpKind::Timeout, -1);
+        if (delay.count() < 0) delay = std::chrono::nanoseconds(0);
+        op->deadline = std::chrono::steady_clock::now() + delay;
+        op->ts.tv_sec = (int64_t)(delay.count() / 1000000000);
+        op->ts.tv_nsec = (long long)(delay.count() % 1000000000);
+        return start(op);
+    }
+
+    // Operations started and not completed yet
+    size_t get_in_flight() {
+        std::lock_guard<std::mutex> lock(track_mtx);
+        return outstanding.size();
+    }
+
+    uint64_t get_completed() {
+        return completed.load(std::memory_order_relaxed);
+    }
+
+    // Drain tasks run so far; get_completed() / get_batches() is the average batch
+    uint64_t get_batches() {
+        return batches.load(std::memory_order_relaxed);
+    }
+};
+
+#endif
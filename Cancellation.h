@@ -0,0 +1,58 @@
+#ifndef CANCELLATION_H
+#define CANCELLATION_H
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+
+// Module 1c: Cooperative Cancellation
+// C++17 stand-in for std::stop_source / std::stop_token. A source hands out
+// any number of tokens; request_stop() flips one shared flag that every
+// token (and every queued task holding one) can read without locking.
+class CancellationToken {
+private:
+    std::shared_ptr<const std::atomic<bool>> state;
+
+    friend class CancellationSource;
+    explicit CancellationToken(std::shared_ptr<const std::atomic<bool>> s) : state(std::move(s)) {}
+
+public:
+    CancellationToken() = default;      // Can never be cancelled
+
+    bool stop_requested() const noexcept {
+        return state && state->load(std::memory_order_acquire);
+    }
+
+    bool stop_possible() const noexcept {
+        return state != nullptr;
+    }
+};
+
+class CancellationSource {
+private:
+    std::shared_ptr<std::atomic<bool>> state;
+
+public:
+    CancellationSource() : state(std::make_shared<std::atomic<bool>>(false)) {}
+
+    CancellationToken get_token() const {
+        return CancellationToken(state);
+    }
+
+    // Returns true for the call that actually cancelled
+    bool request_stop() noexcept {
+        return !state->exchange(true, std::memory_order_acq_rel);
+    }
+
+    bool stop_requested() const noexcept {
+        return state->load(std::memory_order_acquire);
+    }
+};
+
+// Delivered through the future of a task that was cancelled before it started
+class TaskCancelledError : public std::runtime_error {
+public:
+    explicit TaskCancelledError(const char* reason) : std::runtime_error(reason) {}
+};
+
+#endif
@@ -0,0 +1,252 @@
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+#include "ThreadPool.h"
+
+// =========================================
+// MODULE 8: Coroutines (C++20)
+// =========================================
+// Awaitable tasks on top of the pool's worker engine:
+//
+//     CoTask<int> fetch(ThreadPool& pool, int key) {
+//         co_await pool.schedule();            // Continue on a worker
+//         int raw = co_await lookup(key);      // Another CoTask, or a PoolFuture
+//         co_return raw * 2;
+//     }
+//
+//     int v = sync_wait(fetch(pool, 7));       // Block a non-worker thread for the result
+//     spawn(pool, log_everything(pool));       // Or fire and forget
+//
+// A CoTask starts when awaited and, when it finishes, resumes its awaiter
+// directly on the thread it finished on (the worker that ran its last step),
+// without a trip through the queue. A suspended coroutine is just its frame:
+// it holds no worker, so tens of thousands can be in flight on a small pool.
+//
+// Only compiled as C++20 (THREAD_POOL_COROUTINES, see ThreadPool.h);
+// C++17 builds see an empty header.
+
+#ifdef THREAD_POOL_COROUTINES
+
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+template <typename T = void>
+class CoTask;
+
+namespace coro_detail {
+
+// Resumes whoever co_awaited the task (symmetric transfer, so chains of
+// awaits don't grow the stack)
+struct FinalAwaiter {
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+        std::coroutine_handle<> next = handle.promise().continuation;
+        return next ? next : std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept {}
+};
+
+class PromiseBase {
+public:
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+
+    std::suspend_always initial_suspend() const noexcept {
+        return {};
+    }
+
+    FinalAwaiter final_suspend() const noexcept {
+        return {};
+    }
+
+    void unhandled_exception() noexcept {
+        error = std::current_exception();
+    }
+};
+
+template <typename T>
+class Promise : public PromiseBase {
+private:
+    std::optional<T> value;
+
+public:
+    CoTask<T> get_return_object() noexcept;
+
+    template <typename U>
+    void return_value(U&& v) {
+        value.emplace(std::forward<U>(v));
+    }
+
+    T result() {
+        if (error) std::rethrow_exception(error);
+        return std::move(*value);
+    }
+};
+
+template <>
+class Promise<void> : public PromiseBase {
+public:
+    CoTask<void> get_return_object() noexcept;
+
+    void return_void() const noexcept {}
+
+    void result() {
+        if (error) std::rethrow_exception(error);
+    }
+};
+
+// Coroutine that starts right away and frees its own frame when done
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); } // Bodies catch everything
+    };
+};
+
+} // namespace coro_detail
+
+// Lazily started coroutine producing a T. Await it once (co_await std::move(t)
+// or co_await make_task()); destroying an unstarted CoTask just frees it.
+template <typename T>
+class CoTask {
+public:
+    using promise_type = coro_detail::Promise<T>;
+
+private:
+    std::coroutine_handle<promise_type> handle;
+
+public:
+    explicit CoTask(std::coroutine_handle<promise_type> h) noexcept : handle(h) {}
+
+    CoTask(CoTask&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+    CoTask& operator=(CoTask&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+
+    CoTask(const CoTask&) = delete;
+    CoTask& operator=(const CoTask&) = delete;
+
+    ~CoTask() {
+        if (handle) handle.destroy();
+    }
+
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() const noexcept {
+                return handle.done();
+            }
+
+            // Start the task on this thread; it resumes us when it finishes
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+
+            T await_resume() {
+                return handle.promise().result();
+            }
+        };
+        return Awaiter{handle};
+    }
+};
+
+namespace coro_detail {
+
+template <typename T>
+CoTask<T> Promise<T>::get_return_object() noexcept {
+    return CoTask<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline CoTask<void> Promise<void>::get_return_object() noexcept {
+    return CoTask<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+struct SyncLatch {
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool done = false;
+    std::exception_ptr error;
+
+    // Notifies under the lock: the waiter may destroy the latch as soon as it sees 'done'
+    void set() {
+        std::lock_guard<std::mutex> lock(mtx);
+        done = true;
+        cv.notify_one();
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this] { return done; });
+    }
+};
+
+template <typename T, typename Out>
+Detached run_and_signal(CoTask<T>& task, SyncLatch& latch, Out& out) {
+    try {
+        if constexpr (std::is_void<T>::value) {
+            co_await std::move(task);
+        } else {
+            out.emplace(co_await std::move(task));
+        }
+    } catch (...) {
+        latch.error = std::current_exception();
+    }
+    latch.set();
+}
+
+inline Detached run_detached(ThreadPool& pool, CoTask<void> task) {
+    std::exception_ptr error;
+    try {
+        co_await pool.schedule();
+        co_await std::move(task);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    // Rethrown from a pool task, so the pool's exception_handler reports it like any post()
+    if (error) pool.post([error] { std::rethrow_exception(error); });
+}
+
+} // namespace coro_detail
+
+// Run 'task' and block the calling thread until it is done. Meant for
+// main() and other threads outside the pool.
+template <typename T>
+T sync_wait(CoTask<T> task) {
+    coro_detail::SyncLatch latch;
+    std::optional<typename std::conditional<std::is_void<T>::value, char, T>::type> out;
+    coro_detail::run_and_signal(task, latch, out);
+    latch.wait();
+
+    if (latch.error) std::rethrow_exception(latch.error);
+    if constexpr (!std::is_void<T>::value) return std::move(*out);
+}
+
+// Start 'task' on a worker and forget about it. An exception it throws goes
+// to the pool's exception_handler.
+inline void spawn(ThreadPool& pool, CoTask<void> task) {
+    coro_detail::run_detached(pool, std::move(task));
+}
+
+#endif // THREAD_POOL_COROUTINES
+
+#endif
@@ -0,0 +1,210 @@
+#ifndef CPU_TOPOLOGY_H
+#define CPU_TOPOLOGY_H
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Module 2f: CPU Topology
+// Which logical CPUs this process may run on, and which core, package and
+// NUMA node each one belongs to. Read once from Linux sysfs; anywhere else
+// (or if sysfs is missing) every CPU is its own core on a single node.
+struct CpuInfo {
+    int cpu;        // Logical CPU id as the kernel numbers it
+    int core;       // core_id (hyperthreads of one core share it, per package)
+    int package;    // Socket
+    size_t node;    // Dense NUMA node index, 0..node_count()-1
+};
+
+class CpuTopology {
+private:
+    std::vector<CpuInfo> cpu_infos;  // Sorted by cpu id
+    size_t nodes = 1;
+
+    static bool read_line(const std::string& path, std::string& line) {
+        std::ifstream in(path);
+        return in && std::getline(in, line);
+    }
+
+    static int read_int(const std::string& path, int fallback) {
+        std::string line;
+        return read_line(path, line) ? std::atoi(line.c_str()) : fallback;
+    }
+
+    // (node, package, core, cpu) order: hyperthreads of a core end up next to each other
+    std::vector<CpuInfo> compact_order_infos() const {
+        std::vector<CpuInfo> sorted = cpu_infos;
+        std::sort(sorted.begin(), sorted.end(), [](const CpuInfo& a, const CpuInfo& b) {
+            return std::tie(a.node, a.package, a.core, a.cpu) < std::tie(b.node, b.package, b.core, b.cpu);
+        });
+        return sorted;
+    }
+
+public:
+    // "0-3,8,10-11" -> {0,1,2,3,8,10,11}
+    static std::vector<int> parse_cpu_list(const std::string& list) {
+        std::vector<int> cpus;
+        size_t pos = 0;
+        while (pos < list.size()) {
+            size_t end = list.find(',', pos);
+            if (end == std::string::npos) end = list.size();
+            std::string item = list.substr(pos, end - pos);
+            size_t dash = item.find('-');
+            if (!item.empty() && item.find_first_of("0123456789") != std::string::npos) {
+                int first = std::atoi(item.c_str());
+                int last = dash == std::string::npos ? first : std::atoi(item.c_str() + dash + 1);
+                for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+            }
+            pos = end + 1;
+        }
+        return cpus;
+    }
+
+    static CpuTopology detect() {
+        CpuTopology topo;
+
+#if defined(__linux__)
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        bool have_mask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+        // NUMA node ids can be sparse (node0, node2); renumber them densely
+        std::map<int, int> node_of_cpu;
+        std::vector<int> node_ids;
+        if (DIR* dir = opendir("/sys/devices/system/node")) {
+            while (dirent* entry = readdir(dir)) {
+                std::string name = entry->d_name;
+                if (name.compare(0, 4, "node") == 0 && name.size() > 4 && isdigit((unsigned char)name[4])) {
+                    node_ids.push_back(std::atoi(name.c_str() + 4));
+                }
+            }
+            closedir(dir);
+        }
+        std::sort(node_ids.begin(), node_ids.end());
+        for (size_t i = 0; i < node_ids.size(); ++i) {
+            std::string list;
+            if (read_line("/sys/devices/system/node/node" + std::to_string(node_ids[i]) + "/cpulist", list)) {
+                for (int cpu : parse_cpu_list(list)) node_of_cpu[cpu] = (int)i;
+            }
+        }
+
+        std::string online;
+        if (read_line("/sys/devices/system/cpu/online", online)) {
+            for (int cpu : parse_cpu_list(online)) {
+                if (have_mask && (cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &allowed))) continue;
+                std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+                auto node = node_of_cpu.find(cpu);
+                topo.cpu_infos.push_back(CpuInfo{cpu, read_int(base + "core_id", cpu),
+                                                 read_int(base + "physical_package_id", 0),
+                                                 node == node_of_cpu.end() ? 0 : (size_t)node->second});
+            }
+        }
+#endif
+
+        if (topo.cpu_infos.empty()) {
+            unsigned n = std::max(1u, std::thread::hardware_concurrency());
+            for (unsigned cpu = 0; cpu < n; ++cpu) topo.cpu_infos.push_back(CpuInfo{(int)cpu, (int)cpu, 0, 0});
+        }
+
+        // Drop nodes we may not run on, keeping indices dense
+        std::vector<size_t> used;
+        for (const CpuInfo& info : topo.cpu_infos) used.push_back(info.node);
+        std::sort(used.begin(), used.end());
+        used.erase(std::unique(used.begin(), used.end()), used.end());
+        for (CpuInfo& info : topo.cpu_infos) {
+            info.node = std::lower_bound(used.begin(), used.end(), info.node) - used.begin();
+        }
+        topo.nodes = used.size();
+        return topo;
+    }
+
+    const std::vector<CpuInfo>& cpus() const {
+        return cpu_infos;
+    }
+
+    size_t node_count() const {
+        return nodes;
+    }
+
+    // Node index of a logical CPU (0 if unknown)
+    size_t node_of(int cpu) const {
+        for (const CpuInfo& info : cpu_infos) {
+            if (info.cpu == cpu) return info.node;
+        }
+        return 0;
+    }
+
+    std::vector<int> node_cpus(size_t node) const {
+        std::vector<int> cpus;
+        for (const CpuInfo& info : cpu_infos) {
+            if (info.node == node) cpus.push_back(info.cpu);
+        }
+        return cpus;
+    }
+
+    // Fill one node before the next, and both hyperthreads of a core before the next core
+    std::vector<int> compact_order() const {
+        std::vector<int> order;
+        for (const CpuInfo& info : compact_order_infos()) order.push_back(info.cpu);
+        return order;
+    }
+
+    // Round-robin over nodes, then over cores within a node; second hyperthreads come last
+    std::vector<int> scatter_order() const {
+        struct Rank { size_t smt, core, node; int cpu; };
+        std::map<std::tuple<size_t, int, int>, size_t> siblings_seen;  // (node, package, core) -> count
+        std::map<size_t, size_t> cores_seen;                           // node -> distinct cores so far
+        std::vector<Rank> ranks;
+
+        for (const CpuInfo& info : compact_order_infos()) {
+            size_t& smt = siblings_seen[std::make_tuple(info.node, info.package, info.core)];
+            if (smt == 0) cores_seen[info.node]++;
+            ranks.push_back(Rank{smt++, cores_seen[info.node] - 1, info.node, info.cpu});
+        }
+        std::sort(ranks.begin(), ranks.end(), [](const Rank& a, const Rank& b) {
+            return std::tie(a.smt, a.core, a.node) < std::tie(b.smt, b.core, b.node);
+        });
+        std::vector<int> order;
+        for (const Rank& rank : ranks) order.push_back(rank.cpu);
+        return order;
+    }
+};
+
+// Restrict the calling thread to 'cpus'. Returns false if the OS refused
+// (or on platforms without thread affinity).
+inline bool pin_current_thread(const std::vector<int>& cpus) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    return !cpus.empty() && pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+// Logical CPU the calling thread is running on right now (-1 if unknown)
+inline int current_cpu() {
+#if defined(__linux__)
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+#endif
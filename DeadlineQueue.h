@@ -0,0 +1,99 @@
+#ifndef DEADLINE_QUEUE_H
+#define DEADLINE_QUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Module 2h: Deadline Queue
+// Min-heap on deadline behind one mutex: pop() always returns the item whose
+// deadline comes first (FIFO among equal deadlines). The item count is kept
+// in an atomic so empty() never takes the lock.
+template <typename T>
+class DeadlineQueue {
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    struct Entry {
+        Clock::time_point deadline;
+        uint64_t seq;
+        T item;
+    };
+
+    // std::push_heap builds a max-heap, so "greater" puts the earliest deadline on top
+    static bool later(const Entry& a, const Entry& b) {
+        return a.deadline != b.deadline ? a.deadline > b.deadline : a.seq > b.seq;
+    }
+
+    std::vector<Entry> heap;
+    std::mutex mtx;
+    uint64_t next_seq = 0;
+    std::atomic<size_t> count{0};
+
+public:
+    void push(Clock::time_point deadline, T item) {
+        std::unique_lock<std::mutex> lock(mtx);
+        heap.push_back(Entry{deadline, next_seq++, std::move(item)});
+        std::push_heap(heap.begin(), heap.end(), later);
+        count.store(heap.size(), std::memory_order_release);
+    }
+
+    bool pop(T& item, Clock::time_point& deadline) {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (heap.empty()) {
+            return false;
+        }
+        std::pop_heap(heap.begin(), heap.end(), later);
+        deadline = heap.back().deadline;
+        item = std::move(heap.back().item);
+        heap.pop_back();
+        count.store(heap.size(), std::memory_order_release);
+        return true;
+    }
+
+    // Overflow shedding: an item already past its deadline if there is one,
+    // else the one with the latest deadline (the least urgent)
+    bool shed(T& item, Clock::time_point now) {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (heap.empty()) {
+            return false;
+        }
+        if (heap.front().deadline < now) {
+            std::pop_heap(heap.begin(), heap.end(), later);
+        } else {
+            auto latest = std::max_element(heap.begin(), heap.end(),
+                                           [](const Entry& a, const Entry& b) { return later(b, a); });
+            std::iter_swap(latest, heap.end() - 1);
+            std::make_heap(heap.begin(), heap.end() - 1, later);
+        }
+        item = std::move(heap.back().item);
+        heap.pop_back();
+        count.store(heap.size(), std::memory_order_release);
+        return true;
+    }
+
+    // Deadline of the item pop() would return next
+    bool next_deadline(Clock::time_point& deadline) {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (heap.empty()) {
+            return false;
+        }
+        deadline = heap.front().deadline;
+        return true;
+    }
+
+    bool empty() const {
+        return count.load(std::memory_order_acquire) == 0;
+    }
+
+    size_t size() const {
+        return count.load(std::memory_order_acquire);
+    }
+};
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <utility>
+#include "ThreadPool.h"
+
+// =========================================
+// MODULE 9: CPU + Blocking Executor
+// =========================================
+// Two pools behind one front: a fixed CPU pool with one worker per core, and
+// an elastic blocking pool for tasks that spend their time waiting (file and
+// socket I/O, sleeps, calls into blocking libraries). The blocking pool
+// starts a thread as soon as a task finds every worker busy, up to
+// blocking_max_threads, and idle ones retire after blocking_keep_alive. So
+// waiting tasks never take a CPU worker, and many can wait at once.
+//
+//     Executor exec;
+//     exec.post_blocking([&] { fetch(url); });   // Waits on the network
+//     exec.submit([&] { return checksum(buf); }); // Pure computation
+//
+// Code already running on the CPU pool that has to block for a moment can
+// use exec.blocking_region() instead (see ThreadPool::blocking_region).
+struct ExecutorOptions {
+    size_t cpu_threads = 0;              // 0 = hardware_concurrency()
+    PoolOptions cpu;                     // Options of the CPU pool
+    size_t blocking_min_threads = 1;
+    size_t blocking_max_threads = 256;
+    std::chrono::milliseconds blocking_keep_alive{10000};
+};
+
+class Executor {
+private:
+    ThreadPool cpu;
+    ThreadPool blocking;
+
+    static size_t cpu_count(const ExecutorOptions& options) {
+        if (options.cpu_threads > 0) return options.cpu_threads;
+        size_t cores = std::thread::hardware_concurrency();
+        return cores > 0 ? cores : 4;
+    }
+
+    static PoolOptions blocking_options(const ExecutorOptions& options) {
+        PoolOptions pool;
+        pool.min_threads = std::max<size_t>(1, options.blocking_min_threads);
+        pool.max_threads = std::max(pool.min_threads, options.blocking_max_threads);
+        pool.keep_alive = options.blocking_keep_alive;
+        pool.grow_on_submit = true;
+        return pool;
+    }
+
+public:
+    explicit Executor(ExecutorOptions options = ExecutorOptions())
+        : cpu(cpu_count(options), options.cpu),
+          blocking(std::max<size_t>(1, options.blocking_min_threads), blocking_options(options)) {}
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    // CPU-bound work
+    template <class F, class... Args>
+    auto submit(F&& f, Args&&... args) {
+        return cpu.submit(std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    template <class F, class... Args>
+    void post(F&& f, Args&&... args) {
+        cpu.post(std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    // Work that mostly waits
+    template <class F, class... Args>
+    auto submit_blocking(F&& f, Args&&... args) {
+        return blocking.submit(std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    template <class F, class... Args>
+    void post_blocking(F&& f, Args&&... args) {
+        blocking.post(std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    // For a CPU task that has to block briefly
+    ThreadPool::BlockingRegion blocking_region() {
+        return cpu.blocking_region();
+    }
+
+    ThreadPool& cpu_pool() {
+        return cpu;
+    }
+
+    ThreadPool& blocking_pool() {
+        return blocking;
+    }
+
+    size_t get_tasks_queued() {
+        return cpu.get_tasks_queued() + blocking.get_tasks_queued();
+    }
+
+    size_t get_workers_count() {
+        return cpu.get_workers_count() + blocking.get_workers_count();
+    }
+
+    void shutdown() {
+        cpu.shutdown();
+        blocking.shutdown();
+    }
+};
+
+#endif
@@ -0,0 +1,541 @@
+#ifndef FUTURE_H
+#define FUTURE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "ThreadPool.h"
+
+// =========================================
+// MODULE 7: Pool Futures & Continuations
+// =========================================
+// std::future can only be waited on. A PoolFuture also takes continuations:
+// then(f) attaches f to the shared state, and whichever thread completes the
+// state schedules f right away, so nobody sits in get() in between.
+//
+//     auto size = submit_future(pool, load, path)
+//         .then([](Blob b) { return decode(std::move(b)); })
+//         .then([](Image img) { return img.width * img.height; }, Launch::Inline);
+//
+// Launch::Post (the default) queues the continuation on the pool;
+// Launch::Inline runs it on the completing thread, which is cheaper for
+// small steps (nested inline continuations fall back to posting after a
+// few levels, so long chains can't overflow the stack). An exception skips
+// the continuations and comes out of the final get().
+//
+// Like std::future, a PoolFuture is consumed by get() or then(). get() blocks,
+// so calling it on a pool worker ties that worker up.
+
+enum class Launch {
+    Post,                               // Queue the continuation on the pool
+    Inline                              // Run it on the thread that completed the future
+};
+
+template <typename T> class PoolFuture;
+template <typename T> class PoolPromise;
+
+namespace future_detail {
+
+struct Unit {};
+
+template <typename T>
+using Stored = typename std::conditional<std::is_void<T>::value, Unit, T>::type;
+
+// One value (or exception) plus at most one continuation
+template <typename T>
+class State {
+private:
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool ready = false;
+    int blocked = 0;                    // Threads in wait()
+    std::optional<Stored<T>> value;
+    std::exception_ptr error;
+    Task continuation;
+
+    // 'first_only': throw if already ready, otherwise leave it and return false
+    template <typename Store>
+    bool complete(Store&& store, bool first_only = true) {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (ready) {
+            if (first_only) throw std::future_error(std::future_errc::promise_already_satisfied);
+            return false;
+        }
+        store();
+        ready = true;
+        Task next = std::move(continuation);
+        bool notify = blocked > 0;
+        lock.unlock();
+
+        if (notify) cv.notify_all();
+        if (next) next();
+        return true;
+    }
+
+public:
+    ThreadPool* const pool;             // Where posted continuations go (null: run inline)
+
+    explicit State(ThreadPool* p) : pool(p) {}
+
+    void set_value(Stored<T> v) {
+        complete([&] { value.emplace(std::move(v)); });
+    }
+
+    void set_error(std::exception_ptr e) {
+        complete([&] { error = e; });
+    }
+
+    // A promise let go of the state: fail it with broken_promise unless it is
+    // ready already (checked and set under one lock)
+    void abandon() {
+        complete([&] { error = std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)); }, false);
+    }
+
+    // 'callback' runs once the state is ready: now, on this thread, if it
+    // already is, otherwise on the thread that completes it
+    void subscribe(Task callback) {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (!ready) {
+            continuation = std::move(callback);
+            return;
+        }
+        lock.unlock();
+        callback();
+    }
+
+    bool is_ready() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return ready;
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mtx);
+        ++blocked;
+        cv.wait(lock, [this] { return ready; });
+        --blocked;
+    }
+
+    // Only once ready
+    bool failed() const { return error != nullptr; }
+    std::exception_ptr get_error() const { return error; }
+    Stored<T>& get_value() { return *value; }
+
+    Stored<T> take() {
+        wait();
+        if (error) std::rethrow_exception(error);
+        return std::move(*value);
+    }
+};
+
+// Complete 'state' with thunk()'s result or exception
+template <typename R, typename Thunk>
+void fulfil(State<R>& state, Thunk&& thunk) {
+    std::exception_ptr error;
+    try {
+        if constexpr (std::is_void<R>::value) {
+            thunk();
+            state.set_value(Unit{});
+        } else {
+            state.set_value(thunk());
+        }
+        return;
+    } catch (...) {
+        error = std::current_exception();
+    }
+    state.set_error(error);
+}
+
+template <typename F, typename T>
+struct then_result {
+    using type = typename std::invoke_result<F, T>::type;
+};
+
+template <typename F>
+struct then_result<F, void> {
+    using type = typename std::invoke_result<F>::type;
+};
+
+// Nesting level of inline continuations on this thread
+inline int& inline_depth() {
+    thread_local int depth = 0;
+    return depth;
+}
+
+constexpr int kMaxInlineDepth = 32;
+
+// Runs f(src's value) into 'next'; what gets posted for Launch::Post
+template <typename T, typename R, typename F>
+class ThenTask {
+private:
+    std::shared_ptr<State<T>> src;
+    std::shared_ptr<State<R>> next;
+    F func;
+
+public:
+    ThenTask(std::shared_ptr<State<T>> s, std::shared_ptr<State<R>> n, F f)
+        : src(std::move(s)), next(std::move(n)), func(std::move(f)) {}
+
+    void operator()() {
+        if (src->failed()) {
+            next->set_error(src->get_error());
+            return;
+        }
+        fulfil(*next, [this]() -> R {
+            if constexpr (std::is_void<T>::value) {
+                return func();
+            } else {
+                return func(std::move(src->get_value()));
+            }
+        });
+    }
+
+    // Dropped by the pool (cancel_all, full queue)
+    void fail(std::exception_ptr error) {
+        next->set_error(error);
+    }
+};
+
+template <typename R, typename Fn>
+class AsyncTask {
+private:
+    std::shared_ptr<State<R>> state;
+    Fn func;
+
+public:
+    AsyncTask(std::shared_ptr<State<R>> s, Fn f) : state(std::move(s)), func(std::move(f)) {}
+
+    void operator()() {
+        fulfil(*state, func);
+    }
+
+    void fail(std::exception_ptr error) {
+        state->set_error(error);
+    }
+};
+
+} // namespace future_detail
+
+template <typename T>
+class PoolFuture {
+private:
+    template <typename U> friend class PoolFuture;
+    friend class PoolPromise<T>;
+    template <typename U> friend PoolFuture<std::vector<U>> when_all(std::vector<PoolFuture<U>>);
+    friend PoolFuture<void> when_all(std::vector<PoolFuture<void>>);
+    template <typename U> friend class WhenAny;
+
+    std::shared_ptr<future_detail::State<T>> state;
+
+    std::shared_ptr<future_detail::State<T>> release() {
+        if (!state) throw std::future_error(std::future_errc::no_state);
+        return std::move(state);
+    }
+
+public:
+    PoolFuture() = default;
+    explicit PoolFuture(std::shared_ptr<future_detail::State<T>> s) : state(std::move(s)) {}
+
+    PoolFuture(PoolFuture&&) noexcept = default;
+    PoolFuture& operator=(PoolFuture&&) noexcept = default;
+    PoolFuture(const PoolFuture&) = delete;
+    PoolFuture& operator=(const PoolFuture&) = delete;
+
+    bool valid() const {
+        return state != nullptr;
+    }
+
+    bool is_ready() const {
+        return state && state->is_ready();
+    }
+
+    void wait() const {
+        if (!state) throw std::future_error(std::future_errc::no_state);
+        state->wait();
+    }
+
+    // Blocks until ready; rethrows the task's exception
+    T get() {
+        auto s = release();
+        if constexpr (std::is_void<T>::value) {
+            s->take();
+        } else {
+            return s->take();
+        }
+    }
+
+    // f(value) (or f() for PoolFuture<void>) once this future is ready
+    template <typename F>
+    auto then(F&& f, Launch launch = Launch::Post)
+        -> PoolFuture<typename future_detail::then_result<typename std::decay<F>::type, T>::type> {
+        using Fn = typename std::decay<F>::type;
+        using R = typename future_detail::then_result<Fn, T>::type;
+        using Step = future_detail::ThenTask<T, R, Fn>;
+
+        auto src = release();
+        auto next = std::make_shared<future_detail::State<R>>(src->pool);
+        ThreadPool* pool = src->pool;
+        Step step(src, next, Fn(std::forward<F>(f)));
+
+        src->subscribe([src_raw = src.get(), step = std::move(step), pool, launch]() mutable {
+            // An exception is just passed on, so it never needs a trip through the queue
+            bool cheap = launch == Launch::Inline || src_raw->failed();
+            int& depth = future_detail::inline_depth();
+            if (pool == nullptr || (cheap && depth < future_detail::kMaxInlineDepth)) {
+                ++depth;
+                step();
+                --depth;
+            } else {
+                pool->post(std::move(step));
+            }
+        });
+        return PoolFuture<R>(std::move(next));
+    }
+
+#ifdef THREAD_POOL_COROUTINES
+    // co_await std::move(future) in a coroutine (C++20): suspends without
+    // holding a thread and resumes on the pool once the value is there
+    auto operator co_await() && {
+        struct Awaiter {
+            std::shared_ptr<future_detail::State<T>> state;
+
+            struct Resume {
+                std::coroutine_handle<> handle;
+
+                void operator()() {
+                    handle.resume();
+                }
+
+                // The value is already there, so a dropped resume just runs here
+                void fail(std::exception_ptr) {
+                    handle.resume();
+                }
+            };
+
+            bool await_ready() {
+                return state->is_ready();
+            }
+
+            void await_suspend(std::coroutine_handle<> handle) {
+                ThreadPool* pool = state->pool;
+                state->subscribe([handle, pool] {
+                    if (pool) {
+                        pool->post(Resume{handle});
+                    } else {
+                        handle.resume();
+                    }
+                });
+            }
+
+            T await_resume() {
+                if constexpr (std::is_void<T>::value) {
+                    state->take();
+                } else {
+                    return state->take();
+                }
+            }
+        };
+        return Awaiter{release()};
+    }
+#endif
+};
+
+// The producer side, for results that come from outside the pool (I/O
+// callbacks, other threads). Destroying an unfulfilled promise fails its
+// future with broken_promise.
+template <typename T>
+class PoolPromise {
+private:
+    std::shared_ptr<future_detail::State<T>> state;
+    bool retrieved = false;
+
+public:
+    // 'pool' runs the future's posted continuations (null: everything inline)
+    explicit PoolPromise(ThreadPool* pool) : state(std::make_shared<future_detail::State<T>>(pool)) {}
+
+    PoolPromise(PoolPromise&&) noexcept = default;
+
+    // The state being replaced is abandoned, as in the destructor
+    PoolPromise& operator=(PoolPromise&& other) noexcept {
+        if (this != &other) {
+            if (state) state->abandon();
+            state = std::move(other.state);
+            retrieved = other.retrieved;
+        }
+        return *this;
+    }
+
+    ~PoolPromise() {
+        if (state) state->abandon();
+    }
+
+    PoolFuture<T> get_future() {
+        if (retrieved) throw std::future_error(std::future_errc::future_already_retrieved);
+        retrieved = true;
+        return PoolFuture<T>(state);
+    }
+
+    template <typename U = T, typename = typename std::enable_if<!std::is_void<U>::value>::type>
+    void set_value(U value) {
+        state->set_value(std::move(value));
+    }
+
+    template <typename U = T, typename = typename std::enable_if<std::is_void<U>::value>::type>
+    void set_value() {
+        state->set_value(future_detail::Unit{});
+    }
+
+    void set_exception(std::exception_ptr error) {
+        state->set_error(error);
+    }
+};
+
+// Run f(args...) on the pool; the result arrives through a PoolFuture
+template <class F, class... Args>
+auto submit_future(ThreadPool& pool, F&& f, Args&&... args)
+    -> PoolFuture<bound_result_t<typename std::decay<F>::type, typename std::decay<Args>::type...>> {
+    using R = bound_result_t<typename std::decay<F>::type, typename std::decay<Args>::type...>;
+    auto state = std::make_shared<future_detail::State<R>>(&pool);
+
+    auto call = [func = typename std::decay<F>::type(std::forward<F>(f)),
+                 bound = std::make_tuple(std::forward<Args>(args)...)]() mutable -> R {
+        return invoke_bound(func, bound);
+    };
+    pool.post(future_detail::AsyncTask<R, decltype(call)>(state, std::move(call)));
+    return PoolFuture<R>(std::move(state));
+}
+
+template <typename T>
+PoolFuture<typename std::decay<T>::type> make_ready_future(ThreadPool& pool, T&& value) {
+    auto state = std::make_shared<future_detail::State<typename std::decay<T>::type>>(&pool);
+    state->set_value(std::forward<T>(value));
+    return PoolFuture<typename std::decay<T>::type>(std::move(state));
+}
+
+namespace future_detail {
+
+// Counts down inputs; the last one completes the output. The first
+// exception completes it early (later results are dropped).
+template <typename T, typename Out>
+struct Join {
+    std::vector<std::optional<Stored<T>>> results;
+    std::atomic<size_t> left;
+    std::atomic<bool> done{false};
+    std::shared_ptr<State<Out>> out;
+
+    Join(size_t n, std::shared_ptr<State<Out>> o) : results(n), left(n), out(std::move(o)) {}
+
+    template <typename Collect>
+    void arrive(State<T>& src, size_t index, Collect&& collect) {
+        if (src.failed()) {
+            if (!done.exchange(true, std::memory_order_acq_rel)) out->set_error(src.get_error());
+            return;
+        }
+        results[index].emplace(std::move(src.get_value()));
+        if (left.fetch_sub(1, std::memory_order_acq_rel) == 1 && !done.exchange(true, std::memory_order_acq_rel)) {
+            fulfil(*out, collect);
+        }
+    }
+};
+
+} // namespace future_detail
+
+// Ready once every input is, with all the values in input order
+template <typename T>
+PoolFuture<std::vector<T>> when_all(std::vector<PoolFuture<T>> futures) {
+    using Out = std::vector<T>;
+    ThreadPool* pool = futures.empty() ? nullptr : futures.front().state->pool;
+    auto out = std::make_shared<future_detail::State<Out>>(pool);
+    if (futures.empty()) {
+        out->set_value(Out());
+        return PoolFuture<Out>(std::move(out));
+    }
+
+    auto join = std::make_shared<future_detail::Join<T, Out>>(futures.size(), out);
+    for (size_t i = 0; i < futures.size(); ++i) {
+        auto src = futures[i].release();
+        future_detail::State<T>* raw = src.get();
+        raw->subscribe([join, src = std::move(src), i]() {
+            join->arrive(*src, i, [&join]() {
+                Out values;
+                values.reserve(join->results.size());
+                for (auto& r : join->results) values.push_back(std::move(*r));
+                return values;
+            });
+        });
+    }
+    return PoolFuture<Out>(std::move(out));
+}
+
+inline PoolFuture<void> when_all(std::vector<PoolFuture<void>> futures) {
+    ThreadPool* pool = futures.empty() ? nullptr : futures.front().state->pool;
+    auto out = std::make_shared<future_detail::State<void>>(pool);
+    if (futures.empty()) {
+        out->set_value(future_detail::Unit{});
+        return PoolFuture<void>(std::move(out));
+    }
+
+    auto join = std::make_shared<future_detail::Join<void, void>>(futures.size(), out);
+    for (size_t i = 0; i < futures.size(); ++i) {
+        auto src = futures[i].release();
+        future_detail::State<void>* raw = src.get();
+        raw->subscribe([join, src = std::move(src), i]() {
+            join->arrive(*src, i, [] {});
+        });
+    }
+    return PoolFuture<void>(std::move(out));
+}
+
+// Which input of when_any() finished first, and its value
+template <typename T>
+struct AnyResult {
+    size_t index;
+    T value;
+};
+
+template <>
+struct AnyResult<void> {
+    size_t index;
+};
+
+template <typename T>
+class WhenAny {
+public:
+    // Ready as soon as the first input is (with its exception, if it failed)
+    static PoolFuture<AnyResult<T>> combine(std::vector<PoolFuture<T>> futures) {
+        if (futures.empty()) throw std::invalid_argument("when_any needs at least one future");
+        auto out = std::make_shared<future_detail::State<AnyResult<T>>>(futures.front().state->pool);
+        auto won = std::make_shared<std::atomic<bool>>(false);
+
+        for (size_t i = 0; i < futures.size(); ++i) {
+            auto src = futures[i].release();
+            future_detail::State<T>* raw = src.get();
+            raw->subscribe([out, won, src = std::move(src), i]() {
+                if (won->exchange(true, std::memory_order_acq_rel)) return;
+                if (src->failed()) {
+                    out->set_error(src->get_error());
+                } else if constexpr (std::is_void<T>::value) {
+                    out->set_value(AnyResult<T>{i});
+                } else {
+                    out->set_value(AnyResult<T>{i, std::move(src->get_value())});
+                }
+            });
+        }
+        return PoolFuture<AnyResult<T>>(std::move(out));
+    }
+};
+
+template <typename T>
+PoolFuture<AnyResult<T>> when_any(std::vector<PoolFuture<T>> futures) {
+    return WhenAny<T>::combine(std::move(futures));
+}
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef LOCK_FREE_QUEUE_H
+#define LOCK_FREE_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+
+// Module 1 (alternative): Lock-Free Task Queue
+// Bounded multi-producer / multi-consumer ring buffer (Dmitry Vyukov's design).
+// Every cell carries a sequence number that says whose turn it is, so a push or
+// a pop is a single CAS on a cursor instead of a mutex round-trip.
+template <typename T>
+class LockFreeQueue {
+private:
+    struct alignas(64) Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> buffer;
+    size_t mask;
+
+    // Producers and consumers hammer different cursors, keep them on separate cache lines
+    alignas(64) std::atomic<size_t> enqueue_pos;
+    alignas(64) std::atomic<size_t> dequeue_pos;
+
+    static size_t round_up_pow2(size_t n) {
+        size_t cap = 2;
+        while (cap < n) cap <<= 1;
+        return cap;
+    }
+
+public:
+    // Capacity is rounded up to a power of two so the index wraps with a mask
+    explicit LockFreeQueue(size_t capacity = 16384)
+        : buffer(new Cell[round_up_pow2(capacity)]),
+          mask(round_up_pow2(capacity) - 1),
+          enqueue_pos(0),
+          dequeue_pos(0) {
+        for (size_t i = 0; i <= mask; ++i) {
+            buffer[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    LockFreeQueue(const LockFreeQueue&) = delete;
+    LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+    // Returns false (and leaves 'item' untouched) when the ring is full
+    bool try_push(T&& item) {
+        Cell* cell;
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &buffer[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // Slot still holds an item from the previous lap
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(item);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Same interface as SafeQueue::push, waits for a free slot if the ring is full
+    void push(T item) {
+        while (!try_push(std::move(item))) {
+            std::this_thread::yield();
+        }
+    }
+
+    // Interface parity with SafeQueue; every item is still its own CAS
+    template <typename Iterator>
+    void push_range(Iterator first, Iterator last) {
+        for (; first != last; ++first) {
+            push(std::move(*first));
+        }
+    }
+
+    bool pop(T& item) {
+        Cell* cell;
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &buffer[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // Nothing published in this slot yet
+            } else {
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        item = std::move(cell->data);
+        cell->data = T();
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Interface parity with SafeQueue; every item is still its own CAS
+    template <typename OutputIt>
+    size_t pop_bulk(OutputIt out, size_t max) {
+        size_t n = 0;
+        T item;
+        while (n < max && pop(item)) {
+            *out++ = std::move(item);
+            ++n;
+        }
+        return n;
+    }
+
+    // Approximate under concurrency, exact when quiescent (good enough for monitoring)
+    size_t size() {
+        size_t tail = enqueue_pos.load(std::memory_order_acquire);
+        size_t head = dequeue_pos.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    bool empty() {
+        return size() == 0;
+    }
+
+    size_t capacity() const {
+        return mask + 1;
+    }
+};
+
+#endif
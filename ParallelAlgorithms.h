@@ -0,0 +1,254 @@
+#ifndef PARALLEL_ALGORITHMS_H
+#define PARALLEL_ALGORITHMS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "ThreadPool.h"
+#include "TaskGroup.h"
+
+// =========================================
+// MODULE 5: Parallel Algorithms
+// =========================================
+// Loops, sorts and scans over an index (or random-access iterator) range, run
+// on a ThreadPool with the calling thread taking part. Every call returns once
+// all the work is done and rethrows the first exception a task threw.
+//
+// The loops don't create a task per element: a range is cut into a task per
+// worker up front, and each piece then splits off its upper half only while
+// some worker is hungry (ThreadPool::needs_work), otherwise it runs
+// grain-sized chunks inline.
+
+namespace parallel_detail {
+
+// Chunk size when the caller passes grain = 0: about 64 chunks per participant
+inline size_t auto_grain(size_t n, size_t participants) {
+    return std::max<size_t>(1, n / (64 * participants));
+}
+
+// Split points for the eager first level: one piece per participant
+inline size_t initial_depth(size_t participants) {
+    size_t depth = 0;
+    while (((size_t)1 << depth) < participants) ++depth;
+    return depth;
+}
+
+template <typename Index, typename Body>
+void for_range(ThreadPool& pool, Index first, Index last, const Body& body, size_t grain, size_t eager_splits) {
+    TaskGroup group(pool);
+
+    while (first != last) {
+        size_t n = (size_t)(last - first);
+        if (n > 2 * grain && (eager_splits > 0 || pool.needs_work())) {
+            if (eager_splits > 0) --eager_splits;
+            Index mid = first + (n / 2);
+            group.run([&pool, mid, last, &body, grain, eager_splits] {
+                for_range(pool, mid, last, body, grain, eager_splits);
+            });
+            last = mid;
+            continue;
+        }
+
+        Index end = first + std::min(n, grain);
+        for (; first != end; ++first) body(first);
+    }
+    group.wait();
+}
+
+template <typename Index, typename T, typename Body, typename Combine>
+T reduce_range(ThreadPool& pool, Index first, Index last, const T& identity,
+               const Body& body, const Combine& combine, size_t grain, size_t eager_splits) {
+    TaskGroup group(pool);
+    std::deque<T> upper;                 // Results of split-off upper halves, highest range first
+    T acc = identity;
+
+    while (first != last) {
+        size_t n = (size_t)(last - first);
+        if (n > 2 * grain && (eager_splits > 0 || pool.needs_work())) {
+            if (eager_splits > 0) --eager_splits;
+            Index mid = first + (n / 2);
+            upper.push_back(identity);
+            T* slot = &upper.back();     // deque::push_back keeps earlier elements in place
+            group.run([&pool, mid, last, &identity, &body, &combine, grain, eager_splits, slot] {
+                *slot = reduce_range(pool, mid, last, identity, body, combine, grain, eager_splits);
+            });
+            last = mid;
+            continue;
+        }
+
+        Index end = first + std::min(n, grain);
+        acc = body(first, end, std::move(acc));
+        first = end;
+    }
+    group.wait();
+
+    // Left-to-right, so 'combine' only has to be associative
+    for (auto it = upper.rbegin(); it != upper.rend(); ++it) {
+        acc = combine(std::move(acc), std::move(*it));
+    }
+    return acc;
+}
+
+// Merge sorted [a, a_last) and [b, b_last) into 'out', moving elements.
+// Large merges split at the middle of the longer run (binary search in the
+// other) and merge both halves in parallel.
+template <typename InIt, typename OutIt, typename Compare>
+void merge_into(ThreadPool& pool, InIt a, InIt a_last, InIt b, InIt b_last, OutIt out,
+                const Compare& comp, size_t cutoff) {
+    size_t na = (size_t)(a_last - a), nb = (size_t)(b_last - b);
+    // A run of 0 or 1 can't be split further (the halves would not shrink)
+    if (na + nb <= cutoff || na <= 1 || nb <= 1) {
+        std::merge(std::make_move_iterator(a), std::make_move_iterator(a_last),
+                   std::make_move_iterator(b), std::make_move_iterator(b_last), out, comp);
+        return;
+    }
+
+    // Equal elements from the left run stay in front, so the merge is stable
+    InIt a_mid, b_mid;
+    if (na >= nb) {
+        a_mid = a + na / 2;
+        b_mid = std::lower_bound(b, b_last, *a_mid, comp);
+    } else {
+        b_mid = b + nb / 2;
+        a_mid = std::upper_bound(a, a_last, *b_mid, comp);
+    }
+    OutIt out_mid = out + ((a_mid - a) + (b_mid - b));
+
+    TaskGroup group(pool);
+    group.run([&pool, a_mid, a_last, b_mid, b_last, out_mid, &comp, cutoff] {
+        merge_into(pool, a_mid, a_last, b_mid, b_last, out_mid, comp, cutoff);
+    });
+    merge_into(pool, a, a_mid, b, b_mid, out, comp, cutoff);
+    group.wait();
+}
+
+// Sort [first, last). The sorted result ends up in [first, last) or, with
+// into_buffer, in the same positions of 'buffer'. Children sort into the
+// other array, so every level is one parallel merge and no extra copies.
+template <typename RandIt, typename BufIt, typename Compare>
+void sort_range(ThreadPool& pool, RandIt first, RandIt last, BufIt buffer, bool into_buffer,
+                const Compare& comp, size_t cutoff) {
+    size_t n = (size_t)(last - first);
+    if (n <= cutoff) {
+        std::sort(first, last, comp);
+        if (into_buffer) std::move(first, last, buffer);
+        return;
+    }
+
+    size_t half = n / 2;
+    RandIt mid = first + half;
+    BufIt buffer_mid = buffer + half;
+    {
+        TaskGroup group(pool);
+        group.run([&pool, mid, last, buffer_mid, into_buffer, &comp, cutoff] {
+            sort_range(pool, mid, last, buffer_mid, !into_buffer, comp, cutoff);
+        });
+        sort_range(pool, first, mid, buffer, !into_buffer, comp, cutoff);
+        group.wait();
+    }
+
+    if (into_buffer) {
+        merge_into(pool, first, mid, mid, last, buffer, comp, cutoff);
+    } else {
+        merge_into(pool, buffer, buffer_mid, buffer_mid, buffer + n, first, comp, cutoff);
+    }
+}
+
+} // namespace parallel_detail
+
+// body(i) for every i in [first, last). grain = 0 picks a chunk size automatically.
+template <typename Index, typename Body>
+void parallel_for(ThreadPool& pool, Index first, Index last, Body body, size_t grain = 0) {
+    if (!(first < last)) return;
+    size_t participants = pool.get_workers_count() + 1;
+    if (grain == 0) grain = parallel_detail::auto_grain((size_t)(last - first), participants);
+    parallel_detail::for_range(pool, first, last, body, grain, parallel_detail::initial_depth(participants));
+}
+
+// Folds [first, last) in chunks: body(chunk_first, chunk_last, acc) returns the
+// new accumulator for one chunk, combine(a, b) merges two partial results
+// (a covers the lower range). identity must be neutral for combine.
+//
+//     long sum = parallel_reduce(pool, 0, n, 0L,
+//         [&](int lo, int hi, long acc) { for (int i = lo; i < hi; ++i) acc += v[i]; return acc; },
+//         std::plus<long>());
+template <typename Index, typename T, typename Body, typename Combine>
+T parallel_reduce(ThreadPool& pool, Index first, Index last, T identity, Body body, Combine combine, size_t grain = 0) {
+    if (!(first < last)) return identity;
+    size_t participants = pool.get_workers_count() + 1;
+    if (grain == 0) grain = parallel_detail::auto_grain((size_t)(last - first), participants);
+    return parallel_detail::reduce_range(pool, first, last, identity, body, combine, grain,
+                                         parallel_detail::initial_depth(participants));
+}
+
+// Parallel merge sort: halves are sorted in parallel down to 'cutoff'
+// elements (std::sort below that), then merged in parallel through one
+// temporary buffer of n elements. Stable merges, but std::sort leaves are not.
+// cutoff = 0 picks n / (16 * participants), at least 16384.
+template <typename RandIt, typename Compare = std::less<typename std::iterator_traits<RandIt>::value_type>>
+void parallel_sort(ThreadPool& pool, RandIt first, RandIt last, Compare comp = Compare(), size_t cutoff = 0) {
+    size_t n = (size_t)(last - first);
+    size_t participants = pool.get_workers_count() + 1;
+    if (cutoff == 0) cutoff = std::max<size_t>(16384, n / (16 * participants));
+    if (n <= cutoff) {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    using Value = typename std::iterator_traits<RandIt>::value_type;
+    // The elements move into the buffer, so sort from there and let the last merge move them back
+    std::vector<Value> buffer(std::make_move_iterator(first), std::make_move_iterator(last));
+    parallel_detail::sort_range(pool, buffer.begin(), buffer.end(), first, true, comp, cutoff);
+}
+
+// Two-pass block scan: reduce every block in parallel, scan the (few) block
+// totals serially, then scan every block again in parallel starting from its
+// offset. d_first may equal first. op must be associative. Returns the end of
+// the output, like std::inclusive_scan.
+template <typename InIt, typename OutIt, typename Op = std::plus<typename std::iterator_traits<InIt>::value_type>>
+OutIt parallel_inclusive_scan(ThreadPool& pool, InIt first, InIt last, OutIt d_first, Op op = Op()) {
+    using Value = typename std::iterator_traits<InIt>::value_type;
+    size_t n = (size_t)(last - first);
+    if (n == 0) return d_first;
+
+    size_t participants = pool.get_workers_count() + 1;
+    size_t blocks = std::min(4 * participants, std::max<size_t>(1, n / 4096));
+    size_t block_size = (n + blocks - 1) / blocks;
+    blocks = (n + block_size - 1) / block_size;
+
+    if (blocks == 1) {
+        Value acc = first[0];
+        d_first[0] = acc;
+        for (size_t i = 1; i < n; ++i) d_first[i] = acc = op(acc, first[i]);
+        return d_first + n;
+    }
+
+    // Pass 1: block totals (the last block's is never needed)
+    std::vector<Value> offsets(blocks, first[0]);
+    parallel_for(pool, (size_t)0, blocks - 1, [&](size_t b) {
+        InIt it = first + b * block_size;
+        Value acc = *it;
+        for (size_t i = 1; i < block_size; ++i) acc = op(acc, it[i]);
+        offsets[b] = acc;
+    }, 1);
+
+    // offsets[b] = everything before block b
+    for (size_t b = 1; b + 1 < blocks; ++b) offsets[b] = op(offsets[b - 1], offsets[b]);
+
+    // Pass 2
+    parallel_for(pool, (size_t)0, blocks, [&](size_t b) {
+        size_t lo = b * block_size;
+        size_t hi = std::min(n, lo + block_size);
+        Value acc = b == 0 ? first[lo] : op(offsets[b - 1], first[lo]);
+        d_first[lo] = acc;
+        for (size_t i = lo + 1; i < hi; ++i) d_first[i] = acc = op(acc, first[i]);
+    }, 1);
+
+    return d_first + n;
+}
+
+#endif
@@ -0,0 +1,213 @@
+#ifndef PRIORITY_LANES_H
+#define PRIORITY_LANES_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include "SafeQueue.h"
+
+// Lock-free latency histogram: 4 buckets per power of two of nanoseconds,
+// so a percentile is off by at most ~19%
+class LatencyHistogram {
+private:
+    static constexpr size_t kSubBuckets = 4;
+    static constexpr size_t kBuckets = 64 * kSubBuckets;
+    std::atomic<uint64_t> counts[kBuckets];
+    std::atomic<uint64_t> total{0};
+
+    static size_t bucket_of(uint64_t ns) {
+        if (ns < kSubBuckets) return (size_t)ns;
+        int msb = 63 - __builtin_clzll(ns);
+        return msb * kSubBuckets + ((ns >> (msb - 2)) & (kSubBuckets - 1));
+    }
+
+    // Largest value that falls into 'bucket'
+    static double upper_bound_ns(size_t bucket) {
+        if (bucket < kSubBuckets) return (double)bucket;
+        size_t msb = bucket / kSubBuckets;
+        double step = (double)(1ull << msb) / kSubBuckets;
+        return (double)(1ull << msb) + step * (bucket % kSubBuckets + 1) - 1;
+    }
+
+public:
+    LatencyHistogram() {
+        for (auto& c : counts) c.store(0, std::memory_order_relaxed);
+    }
+
+    void record(std::chrono::nanoseconds latency) {
+        uint64_t ns = latency.count() > 0 ? (uint64_t)latency.count() : 0;
+        counts[bucket_of(ns)].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const {
+        return total.load(std::memory_order_relaxed);
+    }
+
+    // p in [0, 1], result in microseconds (0 when nothing was recorded)
+    double percentile_us(double p) const {
+        uint64_t n = count();
+        if (n == 0) return 0;
+        uint64_t rank = (uint64_t)(p * (n - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t b = 0; b < kBuckets; ++b) {
+            seen += counts[b].load(std::memory_order_relaxed);
+            if (seen >= rank) return upper_bound_ns(b) / 1000.0;
+        }
+        return upper_bound_ns(kBuckets - 1) / 1000.0;
+    }
+};
+
+// Module 2g: Priority Lanes
+// A fixed number of FIFO lanes, lane 0 first. A bitmask of non-empty lanes
+// lets a worker find the best lane with one atomic load and a ctz, and skip
+// the lanes entirely when they are all empty.
+//
+// Aging: an item that has waited 'aging' in its lane moves up one lane
+// (and waits again before the next step), so a steady stream of urgent
+// work delays low-priority work but never starves it. Aging stops at lane 1:
+// lane 0 only ever holds work submitted there, so an old backlog can't get
+// in front of new top-priority work.
+template <typename T, size_t Lanes>
+class PriorityLanes {
+    static_assert(Lanes >= 1 && Lanes <= 32, "one bit per lane");
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        T item;
+        Clock::time_point queued_at;    // For the latency histogram
+        Clock::time_point waiting_since; // Reset on every promotion
+        size_t origin;                  // Lane it was submitted to
+    };
+
+    SafeQueue<Entry> lanes[Lanes];
+    std::atomic<uint32_t> nonempty{0};
+    std::atomic<size_t> queued{0};
+    LatencyHistogram latency[Lanes];    // Queue wait, by submitted lane
+    std::atomic<uint64_t> promoted[Lanes];
+
+    Clock::duration aging;
+    std::atomic<int64_t> next_aging_pass{0}; // Clock ticks
+
+    void mark(size_t lane) {
+        nonempty.fetch_or(1u << lane, std::memory_order_release);
+    }
+
+    // The lane looked empty: clear its bit, then re-check so a push that set
+    // the bit just before we cleared it is not lost
+    void unmark(size_t lane) {
+        nonempty.fetch_and(~(1u << lane), std::memory_order_acq_rel);
+        if (!lanes[lane].empty()) mark(lane);
+    }
+
+    // At most one thread, a few times per aging period, moves overdue lane heads up
+    void age(Clock::time_point now) {
+        int64_t due = next_aging_pass.load(std::memory_order_relaxed);
+        int64_t ticks = now.time_since_epoch().count();
+        if (ticks < due) return;
+        if (!next_aging_pass.compare_exchange_strong(due, ticks + (aging / 4).count(), std::memory_order_relaxed)) return;
+
+        for (size_t lane = 2; lane < Lanes; ++lane) {
+            Entry entry;
+            while (lanes[lane].pop_if(entry, [&](const Entry& e) { return now - e.waiting_since >= aging; })) {
+                entry.waiting_since = now;
+                promoted[entry.origin].fetch_add(1, std::memory_order_relaxed);
+                lanes[lane - 1].push(std::move(entry));
+                mark(lane - 1);
+            }
+        }
+    }
+
+public:
+    explicit PriorityLanes(std::chrono::milliseconds aging_after) : aging(aging_after) {
+        for (auto& p : promoted) p.store(0, std::memory_order_relaxed);
+    }
+
+    PriorityLanes(const PriorityLanes&) = delete;
+    PriorityLanes& operator=(const PriorityLanes&) = delete;
+
+    void push(size_t lane, T item) {
+        if (lane >= Lanes) lane = Lanes - 1;
+        Clock::time_point now = Clock::now();
+        queued.fetch_add(1, std::memory_order_relaxed);
+        lanes[lane].push(Entry{std::move(item), now, now, lane});
+        mark(lane);
+    }
+
+    // Take the head of the best non-empty lane among [0, lane_limit)
+    bool pop(T& item, size_t lane_limit = Lanes) {
+        if (nonempty.load(std::memory_order_acquire) == 0) return false;
+
+        Clock::time_point now = Clock::now();
+        if (Lanes > 1 && aging.count() > 0) age(now);
+
+        uint32_t window = lane_limit >= 32 ? ~0u : (1u << lane_limit) - 1;
+        uint32_t mask;
+        while ((mask = nonempty.load(std::memory_order_acquire) & window) != 0) {
+            size_t lane = (size_t)__builtin_ctz(mask);
+            Entry entry;
+            if (lanes[lane].pop(entry)) {
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                latency[entry.origin].record(now - entry.queued_at);
+                item = std::move(entry.item);
+                return true;
+            }
+            unmark(lane);
+            window &= ~(1u << lane); // Don't spin on a lane another worker just refilled
+        }
+        return false;
+    }
+
+    // Take any queued item without counting it as started (cancellation)
+    bool discard(T& item) {
+        for (size_t lane = 0; lane < Lanes; ++lane) {
+            Entry entry;
+            if (lanes[lane].pop(entry)) {
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                item = std::move(entry.item);
+                return true;
+            }
+            unmark(lane);
+        }
+        return false;
+    }
+
+    // Take the head of the lowest-priority non-empty lane without counting it
+    // as started (overflow shedding)
+    bool shed(T& item) {
+        for (size_t lane = Lanes; lane-- > 0;) {
+            Entry entry;
+            if (lanes[lane].pop(entry)) {
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                item = std::move(entry.item);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool empty() const {
+        return nonempty.load(std::memory_order_acquire) == 0;
+    }
+
+    size_t size() const {
+        return queued.load(std::memory_order_relaxed);
+    }
+
+    size_t lane_size(size_t lane) {
+        return lanes[lane].size();
+    }
+
+    const LatencyHistogram& lane_latency(size_t lane) const {
+        return latency[lane];
+    }
+
+    uint64_t lane_promotions(size_t lane) const {
+        return promoted[lane].load(std::memory_order_relaxed);
+    }
+};
+
+#endif
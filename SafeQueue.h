@@ -4,6 +4,7 @@
 #include <queue>
 #include <mutex>
 #include <condition_variable>
+#include <utility>
 
 // Module 1: Task Scheduler & Queue Management
 template <typename T>
@@ -17,7 +18,16 @@ public:
 
     void push(T item) {
         std::unique_lock<std::mutex> lock(mtx);
-        queue.push(item);
+        queue.push(std::move(item));
+    }
+
+    // Move a whole batch in under a single lock acquisition
+    template <typename Iterator>
+    void push_range(Iterator first, Iterator last) {
+        std::unique_lock<std::mutex> lock(mtx);
+        for (; first != last; ++first) {
+            queue.push(std::move(*first));
+        }
     }
 
     bool empty() {
@@ -36,10 +46,36 @@ public:
         if (queue.empty()) {
             return false;
         }
-        item = queue.front();
+        item = std::move(queue.front());
         queue.pop();
         return true;
     }
+
+    // Pop the front item only if 'pred(front)' says so
+    template <typename Pred>
+    bool pop_if(T& item, Pred pred) {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (queue.empty() || !pred(queue.front())) {
+            return false;
+        }
+        item = std::move(queue.front());
+        queue.pop();
+        return true;
+    }
+
+    // Take up to 'max' items in one lock round-trip, written through 'out'.
+    // Returns how many were taken (0 when empty).
+    template <typename OutputIt>
+    size_t pop_bulk(OutputIt out, size_t max) {
+        std::unique_lock<std::mutex> lock(mtx);
+        size_t n = 0;
+        while (n < max && !queue.empty()) {
+            *out++ = std::move(queue.front());
+            queue.pop();
+            ++n;
+        }
+        return n;
+    }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,268 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "Cancellation.h"
+
+// Callables with a 'fail(std::exception_ptr)' member (PromiseTask) can be
+// told that they will never run; anything else just gets dropped
+template <typename F, typename = void>
+struct task_has_fail : std::false_type {};
+
+template <typename F>
+struct task_has_fail<F, std::void_t<decltype(std::declval<F&>().fail(std::declval<std::exception_ptr>()))>>
+    : std::true_type {};
+
+// Module 1b: Task Representation
+// Move-only "void()" callable with 64 bytes of inline storage. Unlike
+// std::function it never needs to copy, so a callable that owns a promise
+// (or other move-only state) is stored in place instead of on the heap.
+// Callables that are too big, over-aligned or throwing-move fall back to one allocation.
+class Task {
+public:
+    static constexpr size_t kInlineSize = 64;
+
+private:
+    struct Ops {
+        void (*invoke)(void* self);
+        bool (*fail)(void* self, std::exception_ptr error);
+        void (*relocate)(void* dst, void* src); // Move-construct into dst, destroy src
+        void (*destroy)(void* self);
+    };
+
+    template <typename F>
+    static bool fail_callable(F& f, std::exception_ptr error) {
+        if constexpr (task_has_fail<F>::value) {
+            f.fail(error);
+            return true;
+        } else {
+            return false;
+        }
+    }
+
+    template <typename F>
+    static constexpr bool fits_inline() {
+        return sizeof(F) <= kInlineSize && alignof(F) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible<F>::value;
+    }
+
+    // Callable lives directly in 'storage'
+    template <typename F>
+    struct InlineOps {
+        static void invoke(void* self) { (*static_cast<F*>(self))(); }
+        static bool fail(void* self, std::exception_ptr error) { return fail_callable(*static_cast<F*>(self), error); }
+        static void relocate(void* dst, void* src) {
+            new (dst) F(std::move(*static_cast<F*>(src)));
+            static_cast<F*>(src)->~F();
+        }
+        static void destroy(void* self) { static_cast<F*>(self)->~F(); }
+        static constexpr Ops table{&invoke, &fail, &relocate, &destroy};
+    };
+
+    // 'storage' holds an F* to a heap copy
+    template <typename F>
+    struct HeapOps {
+        static F*& ptr(void* self) { return *static_cast<F**>(self); }
+        static void invoke(void* self) { (*ptr(self))(); }
+        static bool fail(void* self, std::exception_ptr error) { return fail_callable(*ptr(self), error); }
+        static void relocate(void* dst, void* src) {
+            new (dst) F*(ptr(src));
+            ptr(src) = nullptr;
+        }
+        static void destroy(void* self) { delete ptr(self); }
+        static constexpr Ops table{&invoke, &fail, &relocate, &destroy};
+    };
+
+    alignas(std::max_align_t) unsigned char storage[kInlineSize];
+    const Ops* ops;
+
+    void reset() {
+        if (ops) {
+            ops->destroy(storage);
+            ops = nullptr;
+        }
+    }
+
+public:
+    Task() noexcept : ops(nullptr) {}
+
+    template <typename F, typename Fn = typename std::decay<F>::type,
+              typename = typename std::enable_if<!std::is_same<Fn, Task>::value>::type>
+    Task(F&& f) {
+        if constexpr (fits_inline<Fn>()) {
+            new (storage) Fn(std::forward<F>(f));
+            ops = &InlineOps<Fn>::table;
+        } else {
+            new (storage) Fn*(new Fn(std::forward<F>(f)));
+            ops = &HeapOps<Fn>::table;
+        }
+    }
+
+    Task(Task&& other) noexcept : ops(other.ops) {
+        if (ops) {
+            ops->relocate(storage, other.storage);
+            other.ops = nullptr;
+        }
+    }
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other.ops) {
+                other.ops->relocate(storage, other.storage);
+                ops = other.ops;
+                other.ops = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        reset();
+    }
+
+    explicit operator bool() const noexcept {
+        return ops != nullptr;
+    }
+
+    void operator()() {
+        ops->invoke(storage);
+    }
+
+    // The task will never run: hand 'error' to whoever waits on its result.
+    // Returns false when nobody is waiting (e.g. a post()ed callable).
+    bool fail(std::exception_ptr error) {
+        return ops && ops->fail(storage, error);
+    }
+};
+
+// Call 'func' with its bound arguments as lvalues, the way std::bind did, so
+// parameters taking T& still work; move-only arguments that can only be
+// taken by value or T&& are moved in instead
+template <typename F, typename... Args>
+decltype(auto) invoke_bound(F& func, std::tuple<Args...>& args) {
+    if constexpr (std::is_invocable<F&, Args&...>::value) {
+        return std::apply(func, args);
+    } else {
+        return std::apply(std::move(func), std::move(args));
+    }
+}
+
+// What invoke_bound() returns for a decayed callable and arguments
+template <typename F, typename... Args>
+using bound_result_t = decltype(invoke_bound(std::declval<F&>(), std::declval<std::tuple<Args...>&>()));
+
+// A callable plus its bound arguments, for fire-and-forget work (no promise)
+template <typename F, typename... Args>
+class BoundTask {
+private:
+    F func;
+    std::tuple<Args...> args;
+
+public:
+    template <typename Fn, typename... A>
+    explicit BoundTask(Fn&& f, A&&... a)
+        : func(std::forward<Fn>(f)), args(std::forward<A>(a)...) {}
+
+    void operator()() {
+        invoke_bound(func, args);
+    }
+};
+
+// Fire-and-forget work with a fallback: if the pool sheds the task instead of
+// running it (deadline passed, bounded queue dropped it), on_expire runs instead
+template <typename OnExpire, typename Inner>
+class ExpiringTask {
+private:
+    Inner inner;
+    OnExpire on_expire;
+
+public:
+    template <typename E, typename I>
+    ExpiringTask(E&& e, I&& i) : inner(std::forward<I>(i)), on_expire(std::forward<E>(e)) {}
+
+    void operator()() {
+        inner();
+    }
+
+    void fail(std::exception_ptr) {
+        on_expire();
+    }
+};
+
+// Checks its token right before running: a task cancelled while queued is
+// skipped (its future, if any, gets TaskCancelledError) instead of having
+// to be found and unlinked from the queue
+template <typename Inner>
+class CancellableTask {
+private:
+    Inner inner;
+    CancellationToken token;
+    std::atomic<uint64_t>* cancelled_count;
+
+public:
+    CancellableTask(Inner i, CancellationToken t, std::atomic<uint64_t>* counter)
+        : inner(std::move(i)), token(std::move(t)), cancelled_count(counter) {}
+
+    void operator()() {
+        if (token.stop_requested()) {
+            cancelled_count->fetch_add(1, std::memory_order_relaxed);
+            if constexpr (task_has_fail<Inner>::value) {
+                inner.fail(std::make_exception_ptr(TaskCancelledError("ThreadPool task cancelled before it started")));
+            }
+            return;
+        }
+        inner();
+    }
+
+    // Only forwarded when the inner task has someone to tell
+    template <typename I = Inner, typename = typename std::enable_if<task_has_fail<I>::value>::type>
+    void fail(std::exception_ptr error) {
+        inner.fail(error);
+    }
+};
+
+// A callable plus its bound arguments plus the promise that receives its result.
+// Replaces make_shared<packaged_task>(std::bind(...)): for small callables the
+// whole thing sits inside Task's inline buffer, the only allocation left is the
+// future's shared state.
+template <typename R, typename F, typename... Args>
+class PromiseTask {
+private:
+    F func;
+    std::tuple<Args...> args;
+    std::promise<R> promise;
+
+public:
+    template <typename Fn, typename... A>
+    explicit PromiseTask(std::promise<R>&& p, Fn&& f, A&&... a)
+        : func(std::forward<Fn>(f)), args(std::forward<A>(a)...), promise(std::move(p)) {}
+
+    void operator()() {
+        try {
+            if constexpr (std::is_void<R>::value) {
+                invoke_bound(func, args);
+                promise.set_value();
+            } else {
+                promise.set_value(invoke_bound(func, args));
+            }
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+    }
+
+    void fail(std::exception_ptr error) {
+        promise.set_exception(error);
+    }
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef TASK_BATCH_H
+#define TASK_BATCH_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Module 2c: Worker-Local Task Batch
+// A handful of tasks a worker claimed from the shared queue in one visit.
+// The owner takes them in order, but any idle worker may claim an unstarted
+// one too, so the rest of a batch never waits behind one slow task.
+//
+// One 64-bit word holds generation:32 | count:16 | claimed:16. Claiming is a
+// CAS that bumps 'claimed'; the generation stops a stale claimer from
+// grabbing a slot after the owner has refilled the batch.
+template <typename T>
+class TaskBatch {
+public:
+    static constexpr size_t kMaxBatch = 1024;
+
+private:
+    std::vector<T> slots;
+    alignas(64) std::atomic<uint64_t> state;
+    std::atomic<size_t> taken;           // Claimed slots whose item has been moved out
+
+    static size_t count_of(uint64_t s) { return (s >> 16) & 0xFFFF; }
+    static size_t claimed_of(uint64_t s) { return s & 0xFFFF; }
+
+public:
+    explicit TaskBatch(size_t capacity)
+        : slots(capacity < 1 ? 1 : (capacity > kMaxBatch ? kMaxBatch : capacity)), state(0), taken(0) {}
+
+    TaskBatch(const TaskBatch&) = delete;
+    TaskBatch& operator=(const TaskBatch&) = delete;
+
+    size_t capacity() const {
+        return slots.size();
+    }
+
+    // Any thread
+    bool claim(T& item) {
+        uint64_t s = state.load(std::memory_order_acquire);
+        while (claimed_of(s) < count_of(s)) {
+            if (state.compare_exchange_weak(s, s + 1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                item = std::move(slots[claimed_of(s)]);
+                taken.fetch_add(1, std::memory_order_release);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t unclaimed() {
+        uint64_t s = state.load(std::memory_order_acquire);
+        return count_of(s) - claimed_of(s);
+    }
+
+    // Owner only, after claim() has failed. 'fill(first, max)' writes up to
+    // 'max' items starting at 'first' and returns how many it wrote.
+    template <typename Fill>
+    size_t refill(Fill fill, size_t max) {
+        uint64_t s = state.load(std::memory_order_acquire);
+
+        // A claimer may still be moving its item out of the previous batch
+        while (taken.load(std::memory_order_acquire) < count_of(s)) {
+            std::this_thread::yield();
+        }
+
+        size_t n = fill(slots.begin(), max < slots.size() ? max : slots.size());
+        taken.store(0, std::memory_order_relaxed);
+        uint64_t generation = (s >> 32) + 1;
+        state.store((generation << 32) | ((uint64_t)n << 16), std::memory_order_release);
+        return n;
+    }
+};
+
+#endif
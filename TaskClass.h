@@ -0,0 +1,171 @@
+#ifndef TASK_CLASS_H
+#define TASK_CLASS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include "Task.h"
+
+// Module 2k: Task Classes
+// Named classes of tasks with their own limits, for work that shares a
+// downstream resource (a database, a rate-limited API). See ThreadPool::task_class().
+struct TaskClassLimits {
+    size_t max_concurrent = 0;          // Tasks of the class running at once (0 = no cap)
+    double rate_per_second = 0;         // Task starts per second (0 = no rate limit)
+    double burst = 1;                   // Starts allowed back to back after an idle spell
+};
+
+struct TaskClassStats {
+    size_t running = 0;
+    size_t parked = 0;                  // Waiting for the class's limits
+    uint64_t started = 0;
+    uint64_t throttled = 0;             // Tasks that had to wait at all
+};
+
+// Unbounded multi-producer / single-consumer queue (Dmitry Vyukov's design):
+// a push is one exchange on the head, a pop only touches the tail. A pop can
+// miss an item whose push is still in progress; that producer comes back
+// after finishing the push, so the caller just stops.
+template <typename T>
+class MpscQueue {
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value;
+    };
+
+    alignas(64) std::atomic<Node*> head;
+    alignas(64) Node* tail;             // Consumed dummy; tail->next is the oldest item
+
+public:
+    MpscQueue() : head(new Node()), tail(head.load(std::memory_order_relaxed)) {}
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    ~MpscQueue() {
+        T ignored;
+        while (pop(ignored)) {}
+        delete tail;
+    }
+
+    void push(T value) {
+        Node* node = new Node();
+        node->value = std::move(value);
+        Node* prev = head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    // Consumer only
+    bool pop(T& value) {
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr) return false;
+        value = std::move(next->value);
+        delete tail;
+        tail = next;
+        return true;
+    }
+};
+
+// Token bucket as a generic cell rate algorithm: one atomic "theoretical
+// arrival time" instead of a token count plus refill timestamp, so taking a
+// token is a single CAS
+class RateLimiter {
+private:
+    std::atomic<int64_t> arrival{0};    // ns on the steady clock
+    std::atomic<int64_t> interval{0};   // ns per token (0 = unlimited)
+    std::atomic<int64_t> tolerance{0};  // (burst - 1) * interval
+
+public:
+    static int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void configure(double rate_per_second, double burst) {
+        if (rate_per_second <= 0) {
+            interval.store(0, std::memory_order_relaxed);
+            return;
+        }
+        int64_t step = (int64_t)(1e9 / rate_per_second);
+        if (step < 1) step = 1;
+        tolerance.store((int64_t)((burst > 1 ? burst - 1 : 0) * step), std::memory_order_relaxed);
+        interval.store(step, std::memory_order_relaxed);
+    }
+
+    // On failure 'retry_at' is when the next token will be there
+    bool try_acquire(int64_t& retry_at) {
+        int64_t step = interval.load(std::memory_order_relaxed);
+        if (step == 0) return true;
+        int64_t slack = tolerance.load(std::memory_order_relaxed);
+        int64_t now = now_ns();
+        int64_t seen = arrival.load(std::memory_order_relaxed);
+        while (true) {
+            int64_t start = seen > now ? seen : now;
+            if (start - now > slack) {
+                retry_at = start - slack;
+                return false;
+            }
+            if (arrival.compare_exchange_weak(seen, start + step, std::memory_order_relaxed)) return true;
+        }
+    }
+
+    // Give back a token taken by try_acquire()
+    void refund() {
+        int64_t step = interval.load(std::memory_order_relaxed);
+        if (step != 0) arrival.fetch_sub(step, std::memory_order_relaxed);
+    }
+};
+
+// Shared state of one class; owned by the pool, never freed before it
+struct TaskClassState {
+    std::string name;
+    std::atomic<size_t> max_concurrent{0};
+    RateLimiter rate;
+
+    std::atomic<size_t> running{0};     // Holding a slot: queued in the pool or executing
+    MpscQueue<Task> queue;              // Parked tasks, oldest first
+    std::atomic<size_t> parked{0};
+    std::atomic<bool> pumping{false};   // Whoever sets it is the parked queue's consumer
+    std::atomic<bool> refill_armed{false};
+    std::atomic<uint64_t> started{0};
+    std::atomic<uint64_t> throttled{0};
+
+    explicit TaskClassState(std::string n) : name(std::move(n)) {}
+
+    // A running slot under the concurrency cap
+    bool try_take_slot() {
+        size_t cap = max_concurrent.load(std::memory_order_relaxed);
+        size_t now = running.load(std::memory_order_seq_cst);
+        while (cap == 0 || now < cap) {
+            if (running.compare_exchange_weak(now, now + 1, std::memory_order_seq_cst)) return true;
+        }
+        return false;
+    }
+};
+
+// Handle naming a task class, from ThreadPool::task_class(). Cheap to copy;
+// valid as long as the pool.
+class TaskClass {
+private:
+    TaskClassState* state = nullptr;
+
+    friend class ThreadPool;
+    explicit TaskClass(TaskClassState* s) : state(s) {}
+
+public:
+    TaskClass() = default;
+
+    const std::string& name() const {
+        return state->name;
+    }
+
+    bool valid() const {
+        return state != nullptr;
+    }
+};
+
+#endif
@@ -0,0 +1,360 @@
+#ifndef TASK_GRAPH_H
+#define TASK_GRAPH_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ThreadPool.h"
+
+// =========================================
+// MODULE 6: Task Graphs
+// =========================================
+// A DAG of tasks built once and run any number of times. Each node keeps an
+// atomic count of unfinished predecessors; the node that brings a
+// successor's count to zero releases it, so no task ever blocks on another.
+// One released successor runs inline on the same thread (a chain A -> B -> C
+// never goes back through the queue), the others go to the graph's ready
+// queue, with one pump task per node posted to the pool to take them.
+//
+//     TaskGraph graph;
+//     auto a = graph.add("load_a", [&] { ... });
+//     auto b = graph.add("load_b", [&] { ... });
+//     auto c = graph.add("join", [&] { ... });
+//     graph.precede(a, c);
+//     graph.precede(b, c);
+//     graph.run(pool);                 // again next frame, nothing reallocated
+//
+// run() returns once the graph is done. Meanwhile the caller runs ready
+// nodes itself and only sleeps while all of them are running elsewhere, so
+// a pool task can run a graph even on a single-worker pool.
+
+// Longest chain of the last run, by measured node time
+struct CriticalPath {
+    std::vector<size_t> nodes;          // First to last
+    std::chrono::nanoseconds length{0};
+    std::chrono::nanoseconds total_work{0}; // Sum over all nodes; total_work / length bounds the speedup
+};
+
+class TaskGraph {
+private:
+    struct Node {
+        std::string name;
+        std::function<void()> work;
+        std::vector<size_t> successors;
+        size_t predecessors = 0;
+        std::atomic<size_t> remaining{0};
+        int64_t duration_ns = 0;        // Of the last run
+
+        Node(std::string n, std::function<void()> w) : name(std::move(n)), work(std::move(w)) {}
+        Node(Node&& other) noexcept
+            : name(std::move(other.name)), work(std::move(other.work)),
+              successors(std::move(other.successors)), predecessors(other.predecessors),
+              duration_ns(other.duration_ns) {}
+    };
+
+    // Ready nodes, progress and outcome of one run. Shared with the pumps,
+    // so the last node can signal it after run() may already have returned,
+    // and a pump left over from an earlier run can't touch a later one.
+    struct RunState {
+        std::mutex ready_mtx;
+        std::deque<size_t> ready;       // Released, not started yet
+        std::atomic<size_t> pending{0}; // Nodes not finished (or skipped) yet
+        std::atomic<bool> failed{false};
+        std::atomic<bool> finished{false};
+        std::atomic<int> waiters{0};
+        WakeupSignal done;
+
+        std::mutex error_mtx;
+        std::exception_ptr error;       // First exception of the run
+
+        void record(std::exception_ptr e) {
+            std::lock_guard<std::mutex> lock(error_mtx);
+            if (!error) error = e;
+            failed.store(true, std::memory_order_release);
+        }
+
+        bool take_oldest(size_t& id) {
+            std::lock_guard<std::mutex> lock(ready_mtx);
+            if (ready.empty()) return false;
+            id = ready.front();
+            ready.pop_front();
+            return true;
+        }
+
+        bool take_newest(size_t& id) {
+            std::lock_guard<std::mutex> lock(ready_mtx);
+            if (ready.empty()) return false;
+            id = ready.back();
+            ready.pop_back();
+            return true;
+        }
+
+        bool has_ready() {
+            std::lock_guard<std::mutex> lock(ready_mtx);
+            return !ready.empty();
+        }
+
+        // Pairs with the fence in run(): either the waiter's re-check sees the
+        // change, or we see it in 'waiters'
+        void wake_waiters() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (waiters.load(std::memory_order_relaxed) > 0) done.notify_all();
+        }
+    };
+
+    // What the pool queues, one per released node: runs the oldest ready
+    // node, or nothing if run()'s caller already took them all. A node still
+    // in the queue keeps the run (and so the graph) alive.
+    class NodePump {
+    private:
+        TaskGraph* graph;
+        std::shared_ptr<RunState> state;
+
+    public:
+        NodePump(TaskGraph* g, std::shared_ptr<RunState> s) : graph(g), state(std::move(s)) {}
+
+        void operator()() {
+            size_t id;
+            if (state->take_oldest(id)) graph->execute(state, id);
+        }
+
+        // Dropped by the pool: the run fails, but successors still drain so run() returns
+        void fail(std::exception_ptr error) {
+            size_t id;
+            if (!state->take_oldest(id)) return;
+            state->record(error);
+            graph->execute(state, id);
+        }
+    };
+
+    std::vector<Node> nodes;
+    std::vector<size_t> sources;        // Nodes without predecessors
+    std::vector<size_t> topo_order;
+    bool compiled = false;
+
+    ThreadPool* pool = nullptr;
+    std::atomic<bool> running{false};
+    std::shared_ptr<RunState> state = std::make_shared<RunState>(); // Of the last run
+
+    void release(const std::shared_ptr<RunState>& run, size_t id) {
+        {
+            std::lock_guard<std::mutex> lock(run->ready_mtx);
+            run->ready.push_back(id);
+        }
+        run->wake_waiters();            // run()'s caller can take it
+        pool->post(NodePump(this, run));
+    }
+
+    // Counts predecessors and orders the nodes (Kahn's algorithm); a node
+    // left over means a cycle
+    void compile() {
+        for (auto& node : nodes) node.predecessors = 0;
+        for (auto& node : nodes) {
+            for (size_t s : node.successors) ++nodes[s].predecessors;
+        }
+
+        sources.clear();
+        topo_order.clear();
+        topo_order.reserve(nodes.size());
+        std::vector<size_t> indegree(nodes.size());
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            indegree[i] = nodes[i].predecessors;
+            if (indegree[i] == 0) {
+                sources.push_back(i);
+                topo_order.push_back(i);
+            }
+        }
+        for (size_t k = 0; k < topo_order.size(); ++k) {
+            for (size_t s : nodes[topo_order[k]].successors) {
+                if (--indegree[s] == 0) topo_order.push_back(s);
+            }
+        }
+        if (topo_order.size() != nodes.size()) {
+            throw std::logic_error("TaskGraph has a cycle");
+        }
+        compiled = true;
+    }
+
+    // Run node 'id', then every successor it releases: one inline, the rest queued.
+    // After a failure the remaining nodes are skipped but still counted down.
+    // The caller keeps 'run' alive: the graph may be gone once it finishes.
+    void execute(const std::shared_ptr<RunState>& run, size_t id) {
+        while (true) {
+            Node& node = nodes[id];
+            if (!run->failed.load(std::memory_order_acquire)) {
+                auto start = std::chrono::steady_clock::now();
+                try {
+                    node.work();
+                } catch (...) {
+                    run->record(std::current_exception());
+                }
+                node.duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+            }
+
+            size_t next = SIZE_MAX;
+            for (size_t s : node.successors) {
+                if (nodes[s].remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) continue;
+                if (next == SIZE_MAX) {
+                    next = s;
+                } else {
+                    release(run, s);
+                }
+            }
+
+            if (run->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                // run() may return and the graph be destroyed as soon as
+                // 'finished' is set; the wake-up only touches the run
+                run->finished.store(true, std::memory_order_release);
+                run->wake_waiters();
+                return;
+            }
+            if (next == SIZE_MAX) return;
+            id = next;
+        }
+    }
+
+public:
+    TaskGraph() = default;
+
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+    // Returns the node's id for precede()
+    template <typename F>
+    size_t add(std::string name, F&& work) {
+        nodes.emplace_back(std::move(name), std::function<void()>(std::forward<F>(work)));
+        compiled = false;
+        return nodes.size() - 1;
+    }
+
+    template <typename F>
+    size_t add(F&& work) {
+        return add("node" + std::to_string(nodes.size()), std::forward<F>(work));
+    }
+
+    // 'before' must finish before 'after' starts
+    void precede(size_t before, size_t after) {
+        if (before >= nodes.size() || after >= nodes.size()) {
+            throw std::out_of_range("TaskGraph::precede: no such node");
+        }
+        nodes[before].successors.push_back(after);
+        compiled = false;
+    }
+
+    // Execute every node once, respecting the edges, and wait for all of them,
+    // running ready nodes on the calling thread meanwhile. Rethrows the first
+    // exception a node threw; nodes not started by then are skipped.
+    void run(ThreadPool& p) {
+        if (nodes.empty()) return;
+        if (running.exchange(true, std::memory_order_acquire)) {
+            throw std::logic_error("TaskGraph is already running");
+        }
+
+        try {
+            if (!compiled) compile();
+        } catch (...) {
+            running.store(false, std::memory_order_release);
+            throw;
+        }
+
+        // Pumps of the last run still queued hold its state: start a new one.
+        // Otherwise (the usual case) it is reused, nothing reallocated.
+        if (state.use_count() > 1) {
+            state = std::make_shared<RunState>();
+        } else {
+            state->failed.store(false, std::memory_order_relaxed);
+            state->finished.store(false, std::memory_order_relaxed);
+            state->error = nullptr;
+        }
+        std::shared_ptr<RunState> run = state;
+
+        pool = &p;
+        for (auto& node : nodes) {
+            node.remaining.store(node.predecessors, std::memory_order_relaxed);
+            node.duration_ns = 0;
+        }
+        run->pending.store(nodes.size(), std::memory_order_release);
+
+        for (size_t s : sources) release(run, s);
+
+        while (!run->finished.load(std::memory_order_acquire)) {
+            size_t id;
+            if (run->take_newest(id)) {
+                execute(run, id);
+                continue;
+            }
+
+            // Every ready node is running elsewhere: sleep until one releases
+            // more or the last one finishes
+            uint32_t seen = run->done.prepare();
+            run->waiters.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!run->finished.load(std::memory_order_acquire) && !run->has_ready()) {
+                run->done.wait(seen);
+            }
+            run->waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        std::exception_ptr e;
+        {
+            std::lock_guard<std::mutex> lock(run->error_mtx);
+            std::swap(e, run->error);
+        }
+        running.store(false, std::memory_order_release);
+        if (e) std::rethrow_exception(e);
+    }
+
+    size_t size() const {
+        return nodes.size();
+    }
+
+    const std::string& name(size_t id) const {
+        return nodes.at(id).name;
+    }
+
+    // Measured time of one node in the last run
+    std::chrono::nanoseconds node_time(size_t id) const {
+        return std::chrono::nanoseconds(nodes.at(id).duration_ns);
+    }
+
+    // Longest path through the DAG weighted by the last run's node times
+    CriticalPath critical_path() const {
+        CriticalPath path;
+        if (nodes.empty() || !compiled) return path;
+
+        std::vector<int64_t> finish(nodes.size(), 0); // Longest path ending at each node
+        std::vector<size_t> via(nodes.size(), SIZE_MAX);
+        for (size_t id : topo_order) {
+            finish[id] += nodes[id].duration_ns;
+            path.total_work += std::chrono::nanoseconds(nodes[id].duration_ns);
+            for (size_t s : nodes[id].successors) {
+                if (finish[id] > finish[s] || via[s] == SIZE_MAX) {
+                    finish[s] = finish[id];
+                    via[s] = id;
+                }
+            }
+        }
+
+        size_t last = 0;
+        for (size_t i = 1; i < nodes.size(); ++i) {
+            if (finish[i] > finish[last]) last = i;
+        }
+        path.length = std::chrono::nanoseconds(finish[last]);
+        for (size_t id = last; id != SIZE_MAX; id = via[id]) path.nodes.push_back(id);
+        std::reverse(path.nodes.begin(), path.nodes.end());
+        return path;
+    }
+};
+
+#endif
@@ -0,0 +1,215 @@
+#ifndef TASK_GROUP_H
+#define TASK_GROUP_H
+
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include "ThreadPool.h"
+
+// =========================================
+// MODULE 4: Task Groups
+// =========================================
+// Fork/join on top of a ThreadPool: run() any number of tasks, then wait()
+// for all of them. Completion is one atomic counter, not a future per task.
+//
+// Tasks wait in the group's own deque; the pool only gets a small "pump"
+// task per run() that takes the oldest one. wait() doesn't just block: it
+// runs the group's newest queued tasks itself, and only sleeps once all of
+// them have been started elsewhere. Recursive divide-and-conquer therefore
+// cannot deadlock a saturated pool, and since a waiter never picks up
+// unrelated work, its stack only grows as deep as the recursion itself.
+//
+//     TaskGroup group(pool);
+//     group.run([&] { left = solve(lo, mid); });
+//     group.run([&] { right = solve(mid, hi); });
+//     group.wait();
+class TaskGroup {
+private:
+    struct State {
+        std::mutex queue_mtx;
+        std::deque<Task> queued;         // run() but not started yet
+
+        std::atomic<size_t> pending{0};
+        std::atomic<int> waiters{0};
+        WakeupSignal done;
+        CancellationSource cancellation;
+
+        std::mutex error_mtx;
+        std::exception_ptr error;        // First exception thrown by a task
+
+        void record(std::exception_ptr e) {
+            std::lock_guard<std::mutex> lock(error_mtx);
+            if (!error) error = e;
+        }
+
+        bool take_oldest(Task& task) {
+            std::lock_guard<std::mutex> lock(queue_mtx);
+            if (queued.empty()) return false;
+            task = std::move(queued.front());
+            queued.pop_front();
+            return true;
+        }
+
+        bool has_queued() {
+            std::lock_guard<std::mutex> lock(queue_mtx);
+            return !queued.empty();
+        }
+
+        // Wake wait() for a new task or the last completion. The fence pairs
+        // with the one in wait(): either the waiter's re-check sees the change,
+        // or we see it in 'waiters'.
+        void wake_waiters() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (waiters.load(std::memory_order_relaxed) > 0) done.notify_all();
+        }
+
+        bool take_newest(Task& task) {
+            std::lock_guard<std::mutex> lock(queue_mtx);
+            if (queued.empty()) return false;
+            task = std::move(queued.back());
+            queued.pop_back();
+            return true;
+        }
+
+        void finish() {
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) wake_waiters();
+        }
+    };
+
+    // The state is shared with queued tasks, so a task finishing right after
+    // wait() returned never touches a destroyed group
+    template <typename F>
+    class GroupTask {
+    private:
+        F func;
+        std::shared_ptr<State> state;
+
+    public:
+        GroupTask(F f, std::shared_ptr<State> s) : func(std::move(f)), state(std::move(s)) {}
+
+        void operator()() {
+            if (!state->cancellation.stop_requested()) {
+                try {
+                    func();
+                } catch (...) {
+                    state->record(std::current_exception());
+                }
+            }
+            state->finish();
+        }
+
+        // Dropped by the pool (cancel_all, full queue): still counts as done
+        void fail(std::exception_ptr error) {
+            state->record(error);
+            state->finish();
+        }
+    };
+
+    // What the pool actually queues: one per run(). It runs whichever group
+    // task is oldest, or nothing if wait() already took them all.
+    class GroupPump {
+    private:
+        std::shared_ptr<State> state;
+
+    public:
+        explicit GroupPump(std::shared_ptr<State> s) : state(std::move(s)) {}
+
+        void operator()() {
+            Task task;
+            if (state->take_oldest(task)) task();
+        }
+
+        void fail(std::exception_ptr error) {
+            Task task;
+            if (state->take_oldest(task)) task.fail(error);
+        }
+    };
+
+    ThreadPool& pool;
+    std::shared_ptr<State> state;
+
+    template <typename F>
+    void spawn(F task) {
+        state->pending.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(state->queue_mtx);
+            state->queued.emplace_back(GroupTask<F>(std::move(task), state));
+        }
+        state->wake_waiters();          // A waiter can run it itself
+        pool.post(GroupPump(state));
+    }
+
+public:
+    explicit TaskGroup(ThreadPool& p) : pool(p), state(std::make_shared<State>()) {}
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    // Waits for stragglers; an exception nobody wait()ed for is dropped
+    ~TaskGroup() {
+        try {
+            wait();
+        } catch (...) {
+        }
+    }
+
+    template <class F, class... Args>
+    void run(F&& f, Args&&... args) {
+        if constexpr (sizeof...(Args) == 0) {
+            spawn(typename std::decay<F>::type(std::forward<F>(f)));
+        } else {
+            spawn(BoundTask<typename std::decay<F>::type, typename std::decay<Args>::type...>(
+                std::forward<F>(f), std::forward<Args>(args)...
+            ));
+        }
+    }
+
+    // Block until every task run() so far has finished, running the group's
+    // own queued tasks meanwhile. Rethrows the first exception a task threw (once).
+    void wait() {
+        while (state->pending.load(std::memory_order_acquire) > 0) {
+            Task task;
+            if (state->take_newest(task)) {
+                task();
+                continue;
+            }
+
+            // Nothing left to start: the rest of the group is running on other
+            // threads. Sleep until one of them spawns more or the last one finishes.
+            uint32_t seen = state->done.prepare();
+            state->waiters.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (state->pending.load(std::memory_order_acquire) > 0 && !state->has_queued()) {
+                state->done.wait(seen);
+            }
+            state->waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(state->error_mtx);
+            std::swap(error, state->error);
+        }
+        if (error) std::rethrow_exception(error);
+    }
+
+    // Tasks of this group that have not started yet are skipped; running ones
+    // can poll token()
+    void cancel() {
+        state->cancellation.request_stop();
+    }
+
+    bool is_cancelled() const {
+        return state->cancellation.stop_requested();
+    }
+
+    CancellationToken token() const {
+        return state->cancellation.get_token();
+    }
+};
+
+#endif
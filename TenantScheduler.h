@@ -0,0 +1,261 @@
+#ifndef TENANT_SCHEDULER_H
+#define TENANT_SCHEDULER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Task.h"
+#include "PriorityLanes.h"
+
+// Per-tenant queue depth, queue wait (submit to start) and throughput
+struct TenantStats {
+    unsigned weight = 1;
+    size_t queued = 0;
+    uint64_t started = 0;
+    uint64_t completed = 0;
+    double busy_ms = 0;                 // Run time of its tasks so far
+    double throughput_per_s = 0;        // Completions per second over the last full second
+    double wait_p50_us = 0;
+    double wait_p95_us = 0;
+    double wait_p99_us = 0;
+};
+
+struct TenantState {
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        Task task;
+        Clock::time_point queued_at;
+    };
+
+    std::string name;
+    unsigned weight;
+    std::deque<Entry> queue;
+    bool active = false;                // In the round-robin ring
+    int64_t deficit = 0;                // ns of run time it may still start this round (negative: debt)
+    int64_t estimate_ns;                // Running average run time, charged at start
+
+    uint64_t started = 0;
+    uint64_t completed = 0;
+    int64_t busy_ns = 0;
+    LatencyHistogram wait;
+    Clock::time_point window_start = Clock::now();
+    uint64_t window_completed = 0;
+    double throughput = 0;
+
+    TenantState(std::string n, unsigned w, int64_t estimate)
+        : name(std::move(n)), weight(std::max(1u, w)), estimate_ns(estimate) {}
+};
+
+// Handle naming a tenant, from ThreadPool::tenant(). Cheap to copy; valid as
+// long as the pool.
+class Tenant {
+private:
+    TenantState* state = nullptr;
+
+    friend class ThreadPool;
+    explicit Tenant(TenantState* s) : state(s) {}
+
+public:
+    Tenant() = default;
+
+    const std::string& name() const {
+        return state->name;
+    }
+
+    bool valid() const {
+        return state != nullptr;
+    }
+};
+
+// Module 2l: Tenant Scheduling
+// Deficit round robin over per-tenant FIFO queues, in run time rather than
+// task count: a tenant gets quantum * weight of run time per round, so one
+// with slow tasks doesn't crowd out one with fast tasks just by task count.
+// A task is charged its tenant's average run time when it starts and the
+// difference once it has run, so overruns become debt paid in later rounds.
+// One mutex; the empty check is an atomic load.
+class TenantScheduler {
+private:
+    using Clock = TenantState::Clock;
+    static constexpr int64_t kInitialEstimateNs = 50000;
+
+    std::mutex mtx;
+    std::unordered_map<std::string, std::unique_ptr<TenantState>> tenants;
+    std::vector<TenantState*> ring;     // Tenants with queued work, in visiting order
+    size_t cursor = 0;                  // ring[cursor] is being served
+    int64_t quantum_ns;
+    size_t max_tenants;
+    std::atomic<size_t> queued{0};
+
+    int64_t quantum(const TenantState* t) const {
+        return quantum_ns * (int64_t)t->weight;
+    }
+
+    // Caller holds mtx. Out of the ring, but keeping any debt.
+    void deactivate(size_t position) {
+        TenantState* t = ring[position];
+        bool was_current = position == cursor;
+        t->active = false;
+        t->deficit = std::min<int64_t>(t->deficit, 0);
+        ring.erase(ring.begin() + position);
+        if (ring.empty()) {
+            cursor = 0;
+            return;
+        }
+        if (position < cursor) --cursor;
+        if (cursor >= ring.size()) cursor = 0;
+        if (was_current) ring[cursor]->deficit += quantum(ring[cursor]); // Its turn starts now
+    }
+
+    // Caller holds mtx, ring not empty. Move on until a tenant has credit.
+    TenantState* current() {
+        size_t visited = 0;
+        while (ring[cursor]->deficit <= 0) {
+            if (++visited > ring.size()) {
+                // A whole round without credit (long tasks left debts): skip ahead
+                // by as many rounds as the least indebted tenant needs
+                int64_t rounds = INT64_MAX;
+                for (TenantState* t : ring) rounds = std::min(rounds, (-t->deficit) / quantum(t) + 1);
+                for (TenantState* t : ring) t->deficit += rounds * quantum(t);
+                visited = 0;
+                continue;
+            }
+            cursor = (cursor + 1) % ring.size();
+            ring[cursor]->deficit += quantum(ring[cursor]);
+        }
+        return ring[cursor];
+    }
+
+public:
+    TenantScheduler(std::chrono::microseconds quantum, size_t max_count)
+        : quantum_ns(std::max<int64_t>(1000, std::chrono::duration_cast<std::chrono::nanoseconds>(quantum).count())),
+          max_tenants(max_count) {}
+
+    TenantScheduler(const TenantScheduler&) = delete;
+    TenantScheduler& operator=(const TenantScheduler&) = delete;
+
+    // Existing or new tenant; nullptr if 'name' is new and there are max_tenants already
+    TenantState* get(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto found = tenants.find(name);
+        if (found != tenants.end()) return found->second.get();
+        if (tenants.size() >= max_tenants) return nullptr;
+        std::unique_ptr<TenantState>& slot = tenants[name];
+        slot.reset(new TenantState(name, 1, kInitialEstimateNs));
+        return slot.get();
+    }
+
+    // Takes effect from the tenant's next round
+    void set_weight(TenantState* t, unsigned weight) {
+        std::lock_guard<std::mutex> lock(mtx);
+        t->weight = std::max(1u, weight);
+    }
+
+    void push(TenantState* t, Task task) {
+        std::lock_guard<std::mutex> lock(mtx);
+        t->queue.push_back(TenantState::Entry{std::move(task), Clock::now()});
+        queued.fetch_add(1, std::memory_order_release);
+        if (!t->active) {
+            t->active = true;
+            ring.push_back(t);
+            if (ring.size() == 1) {
+                cursor = 0;
+                t->deficit += quantum(t);
+            }
+        }
+    }
+
+    // Next task by DRR; 'from' and 'charged' go back to complete() after it ran
+    bool pop(Task& task, TenantState*& from, int64_t& charged) {
+        if (queued.load(std::memory_order_acquire) == 0) return false;
+        std::lock_guard<std::mutex> lock(mtx);
+        if (ring.empty()) return false;
+
+        TenantState* t = current();
+        TenantState::Entry& entry = t->queue.front();
+        Clock::time_point now = Clock::now();
+        t->wait.record(now - entry.queued_at);
+        task = std::move(entry.task);
+        t->queue.pop_front();
+        queued.fetch_sub(1, std::memory_order_relaxed);
+
+        charged = t->estimate_ns;
+        t->deficit -= charged;
+        ++t->started;
+        from = t;
+        if (t->queue.empty()) deactivate(cursor);
+        return true;
+    }
+
+    // Settle the start-time charge against what the task actually took. A
+    // tenant that left the ring meanwhile keeps only debt, as in deactivate(),
+    // so it can't come back ahead of the others.
+    void complete(TenantState* t, int64_t charged, int64_t ran_ns) {
+        Clock::time_point now = Clock::now();
+        std::lock_guard<std::mutex> lock(mtx);
+        t->deficit += charged - ran_ns;
+        if (!t->active) t->deficit = std::min<int64_t>(t->deficit, 0);
+        t->estimate_ns = std::max<int64_t>(1000, t->estimate_ns + (ran_ns - t->estimate_ns) / 8);
+        t->busy_ns += ran_ns;
+        ++t->completed;
+        ++t->window_completed;
+        auto elapsed = now - t->window_start;
+        if (elapsed >= std::chrono::seconds(1)) {
+            t->throughput = t->window_completed / std::chrono::duration<double>(elapsed).count();
+            t->window_completed = 0;
+            t->window_start = now;
+        }
+    }
+
+    // Take the oldest task of the longest queue without running it (load
+    // shedding, cancellation): a full pool sheds the tenant that filled it
+    bool shed(Task& task) {
+        if (queued.load(std::memory_order_acquire) == 0) return false;
+        std::lock_guard<std::mutex> lock(mtx);
+        if (ring.empty()) return false;
+        size_t longest = 0;
+        for (size_t i = 1; i < ring.size(); ++i) {
+            if (ring[i]->queue.size() > ring[longest]->queue.size()) longest = i;
+        }
+        TenantState* t = ring[longest];
+        task = std::move(t->queue.front().task);
+        t->queue.pop_front();
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        if (t->queue.empty()) deactivate(longest);
+        return true;
+    }
+
+    TenantStats stats(TenantState* t) {
+        std::lock_guard<std::mutex> lock(mtx);
+        TenantStats s;
+        s.weight = t->weight;
+        s.queued = t->queue.size();
+        s.started = t->started;
+        s.completed = t->completed;
+        s.busy_ms = t->busy_ns / 1e6;
+        s.throughput_per_s = t->throughput;
+        s.wait_p50_us = t->wait.percentile_us(0.50);
+        s.wait_p95_us = t->wait.percentile_us(0.95);
+        s.wait_p99_us = t->wait.percentile_us(0.99);
+        return s;
+    }
+
+    bool empty() const {
+        return queued.load(std::memory_order_acquire) == 0;
+    }
+
+    size_t size() const {
+        return queued.load(std::memory_order_relaxed);
+    }
+};
+
+#endif
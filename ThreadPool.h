@@ -6,71 +6,1582 @@
 #include <functional>
 #include <future>
 #include <atomic>
+#include <memory>
+#include <exception>
+#include <iostream>
+#include <iterator>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
 #include "SafeQueue.h" // Includes Module 1
+#include "Task.h"
+#include "LockFreeQueue.h"
+#include "WorkStealingDeque.h"
+#include "TaskBatch.h"
+#include "WakeupSignal.h"
+#include "CpuTopology.h"
+#include "PriorityLanes.h"
+#include "DeadlineQueue.h"
+#include "TimerWheel.h"
+#include "TaskClass.h"
+#include "TenantScheduler.h"
+
+// C++20 builds get coroutine support: pool.schedule() here, CoTask in Coroutine.h
+#if __cplusplus >= 202002L && __has_include(<coroutine>)
+#include <coroutine>
+#define THREAD_POOL_COROUTINES 1
+#endif
+
+// Which structure backs the pool's task queue
+enum class QueueKind {
+    Mutex,      // SafeQueue: std::queue behind one std::mutex, unbounded
+    LockFree    // LockFreeQueue: bounded MPMC ring, submit waits while it is full
+};
+
+// How workers find their next task
+enum class SchedulingMode {
+    GlobalQueue,    // Every worker pulls from the one shared queue
+    WorkStealing    // Each worker owns a deque; outside submits go to the shared (injection) queue
+};
+
+// What a worker does when it runs out of work
+enum class IdleStrategy {
+    Block,          // Park on the pool's condition variable right away
+    SpinThenPark    // Poll with a pause instruction, then yield, then sleep on a futex
+};
+
+// What submit()/post() do when a bounded pool's shared queue is full
+enum class OverflowPolicy {
+    Block,              // Wait for space
+    BlockWithTimeout,   // Wait up to PoolOptions::overflow_timeout, then reject
+    Reject,             // Fail the new task with QueueFullError
+    DropOldest,         // Fail the oldest queued task with QueueFullError to make room
+    CallerRuns          // Run the new task right away on the submitting thread
+};
+
+// Where worker threads run (Linux only; elsewhere every policy behaves like None)
+enum class Placement {
+    None,           // Let the OS scheduler decide
+    Compact,        // Worker i on the i-th CPU, filling a core's hyperthreads, then a node, first
+    Scatter,        // Worker i round-robin over NUMA nodes, then cores, hyperthreads last
+    CpuList,        // Worker i on PoolOptions::cpu_list[i % size]
+    PerNumaNode     // One shard per node: node-local queue, workers float within their node
+};
+
+// Lanes for submit_with_priority(). Plain submit()/post() work ranks between Normal and Low.
+enum class Priority : unsigned {
+    Critical = 0,
+    High = 1,
+    Normal = 2,
+    Low = 3
+};
+
+// Delivered through the future (or the exception handler for post()) of a task
+// that a bounded queue turned away
+class QueueFullError : public std::runtime_error {
+public:
+    explicit QueueFullError(const char* reason) : std::runtime_error(reason) {}
+};
+
+// Delivered through the future of a submit_with_deadline() task whose deadline
+// passed before a worker could start it
+class DeadlineExpiredError : public std::runtime_error {
+public:
+    explicit DeadlineExpiredError(const char* reason) : std::runtime_error(reason) {}
+};
+
+// How often each overflow outcome happened
+struct OverflowStats {
+    size_t blocked = 0;          // Producer had to wait (Block / BlockWithTimeout)
+    size_t timed_out = 0;        // ...and gave up (BlockWithTimeout)
+    size_t rejected = 0;
+    size_t dropped = 0;
+    size_t caller_ran = 0;
+};
+
+// One priority lane: queue wait (submit to start) percentiles and aging promotions
+struct LaneStats {
+    size_t queued = 0;
+    uint64_t started = 0;
+    uint64_t promoted = 0;       // Times a task from this lane was aged up one lane
+    double p50_us = 0;
+    double p90_us = 0;
+    double p95_us = 0;
+    double p99_us = 0;
+};
+
+// Deadline tasks: started in time vs shed because they had already expired
+struct DeadlineStats {
+    uint64_t started = 0;
+    uint64_t shed = 0;
+};
+
+// Construction-time tuning knobs for a ThreadPool
+struct PoolOptions {
+    SchedulingMode mode = SchedulingMode::GlobalQueue;
+    QueueKind queue_kind = QueueKind::Mutex;
+    size_t queue_capacity = 16384;       // Ring size for QueueKind::LockFree (rounded to a power of two)
+
+    // Batch dequeue: a worker claims up to this many tasks per visit to the shared
+    // queue (1 = one task per visit). The actual size adapts between 1 and this
+    // limit, and idle workers can take unstarted tasks from another worker's batch.
+    size_t dequeue_batch = 1;
+
+    // Bounded queue: at most this many tasks wait in the shared queue (0 = unbounded).
+    // Tasks spawned by tasks of a work-stealing pool go to worker deques and are not capped.
+    size_t max_queued = 0;
+    OverflowPolicy overflow_policy = OverflowPolicy::Block;
+    std::chrono::milliseconds overflow_timeout{100};
+
+    // Called on the worker thread when a post()ed task throws. Empty = log to std::cerr.
+    std::function<void(std::exception_ptr)> exception_handler;
+
+    // Idle behaviour. Spinning trades CPU for wake-up latency on bursty sub-millisecond work.
+    IdleStrategy idle_strategy = IdleStrategy::Block;
+    unsigned spin_polls = 64;            // Queue polls (32 pauses apart) before yielding
+    unsigned yield_polls = 8;            // Queue polls (one yield apart) before sleeping
+
+    // Elastic sizing. With max_threads > 0 a controller adds a worker whenever the
+    // backlog would take longer than grow_after to drain at the current rate, and
+    // workers idle for keep_alive retire, staying within [min_threads, max_threads].
+    // resize() works on any pool.
+    size_t min_threads = 1;
+    size_t max_threads = 0;              // 0 = no controller, fixed size unless resize() is called
+    std::chrono::milliseconds grow_after{50};
+    std::chrono::milliseconds keep_alive{5000};
+    std::chrono::milliseconds scale_interval{10};
+    bool grow_on_submit = false;         // Also start a worker right away when a submit finds none idle (pools of blocking tasks)
+
+    // Stand-in workers blocking_region() may start at once; past it a region
+    // just blocks its worker (0 = the pool's size, max(threads, max_threads))
+    size_t max_blocking_standins = 0;
+
+    // Worker placement. With PerNumaNode, outside submits go to the queue of the
+    // submitter's node, and workers only take work from other nodes when their
+    // own node has none left.
+    Placement placement = Placement::None;
+    std::vector<int> cpu_list;           // For Placement::CpuList
+
+    // A task queued by submit_with_priority() moves up one lane every time it
+    // has waited this long in its current lane, up to High (0 = no aging)
+    std::chrono::milliseconds priority_aging{100};
+
+    // Run time a weight-1 tenant may start per round of the fair-share
+    // scheduler (see ThreadPool::tenant()). Smaller interleaves tenants more
+    // finely; larger lets a tenant keep a worker's caches warm a little longer.
+    std::chrono::microseconds tenant_quantum{1000};
+    size_t max_tenants = 1024;           // Including "default"; tenant() throws std::length_error beyond it
+};
 
 class ThreadPool {
 private:
     // =========================================
     // MODULE 3: Synchronization & Control
     // =========================================
-    std::mutex mtx;                      // Lock for the condition variable
+    std::mutex mtx;                      // Lock for the condition variable (parking only)
     std::condition_variable cv;          // Signaling mechanism to wake threads
     std::atomic<bool> is_shutdown;       // Atomic flag to stop the pool safely
+    std::atomic<size_t> idle_workers{0}; // Workers parked (or about to park); spinners don't count
+
+    IdleStrategy idle_strategy;
+    unsigned spin_polls;
+    unsigned yield_polls;
+    WakeupSignal wakeup;                 // Parking spot for IdleStrategy::SpinThenPark
+
+    std::function<void(std::exception_ptr)> exception_handler;
+    std::atomic<size_t> failed_tasks{0}; // Exceptions that escaped post()ed tasks
+
+    // submit() tasks route exceptions into their future; anything reaching here came from post()
+    void run_task(Task& task) {
+        try {
+            task();
+        } catch (...) {
+            failed_tasks.fetch_add(1, std::memory_order_relaxed);
+            handle_exception(std::current_exception());
+        }
+    }
+
+    void handle_exception(std::exception_ptr error) {
+        if (exception_handler) {
+            exception_handler(error);
+        } else {
+            report_exception(error);
+        }
+    }
+
+    static void report_exception(std::exception_ptr error) {
+        try {
+            std::rethrow_exception(error);
+        } catch (const std::exception& e) {
+            std::cerr << "[ThreadPool] posted task failed: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "[ThreadPool] posted task threw a non-std exception" << std::endl;
+        }
+    }
+
+    // Fail a task that will never run: its future gets the error, a post()ed task
+    // has no future so the exception handler sees it instead
+    void fail_task(Task& task, std::exception_ptr error) {
+        if (!task.fail(error)) {
+            handle_exception(error);
+        }
+    }
+
+    // =========================================
+    // MODULE 3b: Backpressure (bounded queue)
+    // =========================================
+    size_t max_queued;
+    OverflowPolicy overflow_policy;
+    std::chrono::milliseconds overflow_timeout;
+    std::atomic<size_t> queued_slots{0};         // Reserved or occupied shared-queue slots (bounded pools only)
+    std::atomic<size_t> unslotted_queued{0};     // Shared-queue tasks holding no slot (see requeue())
+
+    std::mutex space_mtx;                        // Producers waiting for space park here
+    std::condition_variable space_cv;
+    std::atomic<size_t> blocked_producers{0};
+
+    struct {
+        std::atomic<size_t> blocked{0}, timed_out{0}, rejected{0}, dropped{0}, caller_ran{0};
+    } overflow_counts;
+
+    bool try_reserve_slot() {
+        if (queued_slots.fetch_add(1, std::memory_order_seq_cst) < max_queued) return true;
+        queued_slots.fetch_sub(1, std::memory_order_seq_cst);
+        return false;
+    }
+
+    // Tasks left the shared queue: free their slots and wake blocked producers.
+    // Same handshake as notify_work()/park(), with seq_cst RMWs instead of fences.
+    void release_slots(size_t n) {
+        if (max_queued == 0 || n == 0) return;
+        queued_slots.fetch_sub(n, std::memory_order_seq_cst);
+        if (blocked_producers.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(space_mtx);
+            space_cv.notify_all();
+        }
+    }
+
+    // Tasks left the shared queue. Some may be ones requeue() handed back
+    // without a slot; which ones is unknown, so those are settled first.
+    void release_queue_slots(size_t n) {
+        size_t unslotted = unslotted_queued.load(std::memory_order_relaxed);
+        while (unslotted > 0 && n > 0) {
+            size_t settled = std::min(unslotted, n);
+            if (unslotted_queued.compare_exchange_weak(unslotted, unslotted - settled, std::memory_order_relaxed)) {
+                n -= settled;
+                break;
+            }
+        }
+        release_slots(n);
+    }
+
+    bool wait_for_space(bool with_timeout) {
+        std::unique_lock<std::mutex> lock(space_mtx);
+        blocked_producers.fetch_add(1, std::memory_order_seq_cst);
+
+        bool reserved = true;
+        if (with_timeout) {
+            reserved = space_cv.wait_for(lock, overflow_timeout, [this] { return try_reserve_slot(); });
+        } else {
+            space_cv.wait(lock, [this] { return try_reserve_slot(); });
+        }
+
+        blocked_producers.fetch_sub(1, std::memory_order_seq_cst);
+        return reserved;
+    }
+
+    // Admission control for a task headed to the shared queue. Returns true when it
+    // holds a slot and should be queued, false when the overflow policy disposed of it.
+    bool admit(Task& task) {
+        if (max_queued == 0 || try_reserve_slot()) return true;
+
+        OverflowPolicy policy = overflow_policy;
+
+        // A worker waiting on its own pool's queue could wait forever, so it runs the task itself
+        if ((policy == OverflowPolicy::Block || policy == OverflowPolicy::BlockWithTimeout) &&
+            this_thread_context().pool == this) {
+            policy = OverflowPolicy::CallerRuns;
+        }
+
+        switch (policy) {
+        case OverflowPolicy::Block:
+        case OverflowPolicy::BlockWithTimeout:
+            overflow_counts.blocked++;
+            if (wait_for_space(policy == OverflowPolicy::BlockWithTimeout)) return true;
+            overflow_counts.timed_out++;
+            fail_task(task, std::make_exception_ptr(QueueFullError("ThreadPool queue full: timed out waiting for space")));
+            return false;
+
+        case OverflowPolicy::Reject:
+            overflow_counts.rejected++;
+            fail_task(task, std::make_exception_ptr(QueueFullError("ThreadPool queue full: task rejected")));
+            return false;
+
+        case OverflowPolicy::DropOldest:
+            while (!try_reserve_slot()) {
+                Task oldest;
+                if (dequeue(oldest) || shed_tenant_task(oldest) || shed_lane_task(oldest) ||
+                    shed_deadline_task(oldest)) {
+                    overflow_counts.dropped++;
+                    fail_task(oldest, std::make_exception_ptr(QueueFullError("ThreadPool queue full: dropped for newer work")));
+                } else {
+                    std::this_thread::yield(); // Slots are reserved but not queued yet
+                }
+            }
+            return true;
+
+        case OverflowPolicy::CallerRuns:
+            overflow_counts.caller_ran++;
+            run_task(task);
+            return false;
+        }
+        return true;
+    }
+
+    // =========================================
+    // MODULE 2: Worker Thread Engine
+    // =========================================
+    // The shared queue. Only Placement::PerNumaNode splits it into one shard per node.
+    struct QueueShard {
+        SafeQueue<Task> task_queue;                  // Queue holds move-only "void" tasks
+        std::unique_ptr<LockFreeQueue<Task>> ring_queue; // Used instead of task_queue for QueueKind::LockFree
+        std::atomic<size_t> spilled{0};              // LockFree only: tasks in task_queue because the ring was full
+
+        size_t size() {
+            return ring_queue ? ring_queue->size() + spilled.load(std::memory_order_relaxed) : task_queue.size();
+        }
+
+        bool empty() {
+            return ring_queue ? ring_queue->empty() && spilled.load(std::memory_order_relaxed) == 0 : task_queue.empty();
+        }
+    };
+    std::vector<std::unique_ptr<QueueShard>> shards;
+
+    // Queue dispatch: the lock-free ring when configured, SafeQueue otherwise
+    void enqueue(Task task) {
+        QueueShard& shard = *shards[caller_shard()];
+        if (shard.ring_queue) push_ring(shard, task);
+        else shard.task_queue.push(std::move(task));
+    }
+
+    void enqueue_range(std::vector<Task>& batch) {
+        QueueShard& shard = *shards[caller_shard()];
+        if (shard.ring_queue) {
+            for (Task& task : batch) push_ring(shard, task);
+        } else {
+            shard.task_queue.push_range(batch.begin(), batch.end());
+        }
+    }
+
+    // A full ring only drains if workers are awake, so wake them before waiting
+    // for space (a batch is only announced once it is completely queued). A
+    // worker of this pool may be the only one who could drain it, so it spills
+    // to the shard's (otherwise unused) SafeQueue instead of waiting.
+    void push_ring(QueueShard& shard, Task& task) {
+        while (!shard.ring_queue->try_push(std::move(task))) {
+            if (this_thread_context().pool == this) {
+                shard.task_queue.push(std::move(task));
+                shard.spilled.fetch_add(1, std::memory_order_release);
+                return;
+            }
+            notify_work(shard.ring_queue->size());
+            std::this_thread::yield();
+        }
+    }
+
+    // Spilled tasks (LockFree only) are older than what is in the ring, so they go first
+    bool pop_spilled(QueueShard& shard, Task& task) {
+        if (shard.spilled.load(std::memory_order_acquire) == 0 || !shard.task_queue.pop(task)) return false;
+        shard.spilled.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool dequeue_from(size_t index, Task& task) {
+        QueueShard& shard = *shards[index];
+        bool got = shard.ring_queue ? pop_spilled(shard, task) || shard.ring_queue->pop(task)
+                                    : shard.task_queue.pop(task);
+        if (got) release_queue_slots(1);
+        return got;
+    }
+
+    // Any shard, the caller's own first
+    bool dequeue(Task& task) {
+        size_t home = caller_shard();
+        for (size_t i = 0; i < shards.size(); ++i) {
+            if (dequeue_from((home + i) % shards.size(), task)) return true;
+        }
+        return false;
+    }
+
+    template <typename OutputIt>
+    size_t dequeue_bulk(size_t index, OutputIt out, size_t max) {
+        QueueShard& shard = *shards[index];
+        size_t n;
+        if (shard.ring_queue) {
+            n = 0;
+            while (n < max && pop_spilled(shard, *out)) {
+                ++out;
+                ++n;
+            }
+            n += shard.ring_queue->pop_bulk(out, max - n);
+        } else {
+            n = shard.task_queue.pop_bulk(out, max);
+        }
+        release_queue_slots(n);
+        return n;
+    }
+
+    bool queue_empty() {
+        for (auto& shard : shards) {
+            if (!shard->empty()) return false;
+        }
+        return true;
+    }
+
+    // =========================================
+    // MODULE 2b: Work-Stealing Scheduler
+    // =========================================
+    SchedulingMode mode;
+
+    // Per-worker state, one per worker slot. Deque slots must be trivially
+    // copyable, so tasks pushed from inside the pool are boxed on the heap.
+    struct WorkerState {
+        WorkStealingDeque<Task*> deque;  // Only used in SchedulingMode::WorkStealing
+        TaskBatch<Task> batch;           // Tasks claimed from the shared queue in one visit
+        size_t batch_target;             // Adaptive batch size, 1..dequeue_batch
+        uint64_t rng;                    // xorshift state for picking steal victims
+        size_t shard = 0;                // Home queue shard (NUMA node under PerNumaNode)
+        std::vector<int> cpus;           // Affinity for whoever runs in this slot (empty = unpinned)
+
+        std::thread thread;              // Current (or last, until joined) occupant of the slot
+        std::atomic<bool> active{false};
+        std::atomic<uint64_t> tasks_started{0};
+
+        TenantState* tenant = nullptr;   // Tenant of the task being run, if it came from one
+        int64_t tenant_charge = 0;       // What the scheduler charged it at start (ns)
+
+        WorkerState(uint64_t seed, size_t max_batch) : batch(max_batch), batch_target(1), rng(seed) {}
+
+        ~WorkerState() {
+            Task* boxed;
+            while (deque.pop(boxed)) delete boxed;
+        }
+    };
+
+    // Worker slots never move or die while the pool lives, so thieves can walk
+    // [0, slots_used) without a lock while workers come and go (see resize())
+    std::unique_ptr<std::atomic<WorkerState*>[]> worker_slots;
+    size_t slot_capacity;
+    std::atomic<size_t> slots_used{0};
+
+    WorkerState* state_at(size_t index) {
+        return worker_slots[index].load(std::memory_order_acquire);
+    }
+
+    // Which pool (and which worker slot) the calling thread belongs to
+    struct ThreadContext {
+        ThreadPool* pool = nullptr;
+        size_t index = 0;
+    };
+
+    static ThreadContext& this_thread_context() {
+        static thread_local ThreadContext ctx;
+        return ctx;
+    }
+
+    // The calling worker's state, or nullptr when called from outside this pool
+    WorkerState* local_worker() {
+        ThreadContext& ctx = this_thread_context();
+        return (ctx.pool == this && mode == SchedulingMode::WorkStealing) ? state_at(ctx.index) : nullptr;
+    }
+
+    static uint64_t next_random(uint64_t& state) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    static bool unbox(Task* boxed, Task& task) {
+        task = std::move(*boxed);
+        delete boxed;
+        return true;
+    }
+
+    size_t dequeue_batch;
+
+    // Refill this worker's batch from the shared queue. The target size doubles
+    // while the queue keeps filling it and halves when it comes up short, so a
+    // deep backlog is drained in big gulps but a shallow one is not hoarded.
+    bool take_batch(WorkerState& self, Task& task) {
+        size_t want = self.batch_target;
+        size_t got = self.batch.refill([this, &self](std::vector<Task>::iterator out, size_t max) {
+            return dequeue_bulk(self.shard, out, max);
+        }, want);
+
+        if (got == want) self.batch_target = std::min(want * 2, self.batch.capacity());
+        else self.batch_target = std::max<size_t>(1, want / 2);
+
+        if (got > 1) notify_work(got - 1); // Parked workers may help with the rest
+        return self.batch.claim(task);
+    }
+
+    // Only victims in (or, with same_shard = false, outside) the thief's shard
+    bool eligible_victim(size_t thief, size_t victim, bool same_shard) {
+        return victim != thief && (state_at(victim)->shard == state_at(thief)->shard) == same_shard;
+    }
+
+    // Unstarted tasks sitting in another worker's batch
+    bool steal_batch(size_t thief, Task& task, bool same_shard) {
+        size_t n = slots_used.load(std::memory_order_acquire);
+        size_t start = next_random(state_at(thief)->rng) % n;
+        for (size_t i = 0; i < n; ++i) {
+            size_t victim = (start + i) % n;
+            if (eligible_victim(thief, victim, same_shard) && state_at(victim)->batch.claim(task)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Try every other worker once, starting from a random victim
+    bool try_steal(size_t thief, Task*& boxed, bool same_shard) {
+        size_t n = slots_used.load(std::memory_order_acquire);
+        if (n < 2) return false;
+
+        size_t start = next_random(state_at(thief)->rng) % n;
+        for (size_t i = 0; i < n; ++i) {
+            size_t victim = (start + i) % n;
+            if (eligible_victim(thief, victim, same_shard) && state_at(victim)->deque.steal(boxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool steal_task(size_t thief, Task& task, bool same_shard) {
+        Task* boxed;
+        if (mode == SchedulingMode::WorkStealing && try_steal(thief, boxed, same_shard)) return unbox(boxed, task);
+        return dequeue_batch > 1 && steal_batch(thief, task, same_shard);
+    }
+
+    bool has_work() {
+        if (!lanes.empty() || !deadline_queue.empty() || !tenants.empty() || !queue_empty()) return true;
+        size_t n = slots_used.load(std::memory_order_acquire);
+        for (size_t i = 0; i < n; ++i) {
+            WorkerState* state = state_at(i);
+            if (!state->deque.empty() || state->batch.unclaimed() > 0) return true;
+        }
+        return false;
+    }
+
+    // Own deque (LIFO) -> own batch -> shared queue -> tenant queues -> steal (FIFO) from a random
+    // victim's deque -> unstarted tasks in another worker's batch. With several
+    // shards all of that stays on the home node first; other nodes' queues and
+    // workers are only tried once the home node has nothing left.
+    bool next_task(size_t index, Task& task) {
+        WorkerState& self = *state_at(index);
+        Task* boxed;
+
+        if (take_priority(task, kUrgentLanes)) return true;
+        if (take_deadline(task)) return true;
+
+        if (mode == SchedulingMode::WorkStealing && self.deque.pop(boxed)) return unbox(boxed, task);
+
+        if (dequeue_batch > 1) {
+            if (self.batch.claim(task) || take_batch(self, task)) return true;
+        } else if (dequeue_from(self.shard, task)) {
+            return true;
+        }
+
+        if (take_tenant(self, task)) return true;
+
+        if (steal_task(index, task, true)) return true;
+
+        if (shards.size() > 1) {
+            for (size_t i = 1; i < shards.size(); ++i) {
+                if (dequeue_from((self.shard + i) % shards.size(), task)) return true;
+            }
+            if (steal_task(index, task, false)) return true;
+        }
+        return take_priority(task, kPriorityLanes);
+    }
+
+    // Route a ready task: the worker's own deque when submitted from inside a
+    // work-stealing pool, the default tenant once the pool has tenants, the
+    // shared queue otherwise
+    void schedule(Task task) {
+        if (WorkerState* local = local_worker()) {
+            local->deque.push(new Task(std::move(task)));
+        } else if (tenants_active.load(std::memory_order_acquire)) {
+            schedule_tenant(default_tenant, std::move(task));
+        } else if (admit(task)) {
+            enqueue(std::move(task));
+        }
+    }
+
+    // Producer side of the parking handshake: only touch the lock when someone sleeps,
+    // and wake at most one worker per new task. The fence pairs with the one in park():
+    // either the parking worker sees the new task in its re-check, or we see it in
+    // 'idle_workers' and wake it.
+    void notify_work(size_t new_tasks = 1) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        size_t idle = idle_workers.load(std::memory_order_relaxed);
+        if (idle == 0) {
+            if (grow_on_submit) grow_for(new_tasks);
+            return;
+        }
+        wake_idle(new_tasks, idle);
+    }
+
+    void wake_idle(size_t new_tasks, size_t idle) {
+        if (idle_strategy == IdleStrategy::SpinThenPark) {
+            wakeup.notify((int)std::min<size_t>(new_tasks, idle));
+            return;
+        }
+
+        { std::lock_guard<std::mutex> lock(mtx); } // Parker is either waiting or has not re-checked yet
+        if (new_tasks >= idle) {
+            cv.notify_all();
+        } else {
+            for (size_t i = 0; i < new_tasks; ++i) cv.notify_one();
+        }
+    }
+
+    enum class ParkResult {
+        Woken,      // Go look for work (or a retirement request)
+        Expired,    // Idle for keep_alive without work
+        Shutdown    // Pool stopped and drained
+    };
+
+    bool should_wake() {
+        return has_work() || is_shutdown || retire_requests.load(std::memory_order_relaxed) > 0;
+    }
+
+    // Sleep until there is work. Elastic pools sleep at most keep_alive.
+    ParkResult park() {
+        auto parked_at = std::chrono::steady_clock::now();
+
+        if (idle_strategy == IdleStrategy::SpinThenPark) {
+            // The epoch is read before the re-check, so a notify racing with it is not lost
+            uint32_t seen = wakeup.prepare();
+            idle_workers.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (!should_wake()) {
+                if (elastic) wakeup.wait_for(seen, keep_alive);
+                else wakeup.wait(seen);
+            }
+            idle_workers.fetch_sub(1, std::memory_order_relaxed);
+        } else {
+            std::unique_lock<std::mutex> lock(mtx);
+            idle_workers.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (elastic) {
+                cv.wait_for(lock, keep_alive, [this] { return should_wake(); });
+            } else {
+                cv.wait(lock, [this] { return should_wake(); });
+            }
+            idle_workers.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        if (has_work()) return ParkResult::Woken;
+        if (is_shutdown) return ParkResult::Shutdown;
+        if (elastic && std::chrono::steady_clock::now() - parked_at >= keep_alive) return ParkResult::Expired;
+        return ParkResult::Woken;
+    }
+
+    void wake_all_workers() {
+        { std::lock_guard<std::mutex> lock(mtx); }
+        cv.notify_all();
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        wakeup.notify_all();
+    }
+
+    // Batch version of schedule(): one queue operation for the whole batch
+    void schedule_bulk(std::vector<Task>& batch) {
+        if (WorkerState* local = local_worker()) {
+            for (Task& task : batch) local->deque.push(new Task(std::move(task)));
+        } else if (max_queued > 0) {
+            // Admission is per task, and workers must see each one before the
+            // producer may have to wait for space
+            for (Task& task : batch) {
+                schedule(std::move(task));
+                notify_work();
+            }
+        } else if (tenants_active.load(std::memory_order_acquire)) {
+            for (Task& task : batch) schedule_tenant(default_tenant, std::move(task));
+        } else {
+            enqueue_range(batch);
+        }
+    }
+
+    // SpinThenPark: keep polling for a little while before going to sleep, so work
+    // that arrives microseconds later starts without a wake-up syscall on either side
+    bool spin_for_work(size_t index, Task& task) {
+        for (unsigned poll = 0; poll < spin_polls; ++poll) {
+            for (int i = 0; i < 32; ++i) cpu_relax();
+            if (next_task(index, task)) return true;
+        }
+        for (unsigned poll = 0; poll < yield_polls; ++poll) {
+            std::this_thread::yield();
+            if (next_task(index, task)) return true;
+        }
+        return false;
+    }
+
+    // =========================================
+    // MODULE 2e: Elastic Sizing
+    // =========================================
+    static constexpr size_t kMaxWorkers = 256;
+
+    std::mutex resize_mtx;                       // Serializes starting and retiring workers
+    std::atomic<size_t> live_workers{0};         // Started and not yet committed to leaving
+    std::atomic<size_t> retire_requests{0};      // Workers resize() asked to leave (written under resize_mtx)
+    size_t lower_bound_workers;
+    size_t upper_bound_workers;
+
+    bool elastic;
+    bool grow_on_submit;
+    std::chrono::milliseconds grow_after;
+    std::chrono::milliseconds keep_alive;
+    std::chrono::milliseconds scale_interval;
+    std::thread controller;
+    std::mutex controller_mtx;
+    std::condition_variable controller_cv;
+
+    // Start a worker in the first free slot. Caller holds resize_mtx.
+    void spawn_worker() {
+        while (true) {
+            size_t used = slots_used.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < used; ++i) {
+                WorkerState* state = state_at(i);
+                if (!state->active.load(std::memory_order_acquire)) {
+                    if (state->thread.joinable()) state->thread.join(); // Previous occupant has retired
+                    start_in_slot(state, i);
+                    return;
+                }
+            }
+            if (used < slot_capacity) {
+                WorkerState* state = new WorkerState(0x9E3779B97F4A7C15ull * (used + 1), dequeue_batch);
+                place_slot(*state, used);
+                worker_slots[used].store(state, std::memory_order_release);
+                slots_used.store(used + 1, std::memory_order_release);
+                start_in_slot(state, used);
+                return;
+            }
+            std::this_thread::yield(); // Every slot is still held by a worker on its way out
+        }
+    }
+
+    void start_in_slot(WorkerState* state, size_t index) {
+        state->active.store(true, std::memory_order_relaxed);
+        live_workers.fetch_add(1);
+        state->thread = std::thread(&ThreadPool::worker_loop, this, index);
+    }
+
+    // A worker takes one of the retirements resize() asked for
+    bool claim_retirement() {
+        std::lock_guard<std::mutex> lock(resize_mtx);
+        if (retire_requests.load() == 0) return false;
+        retire_requests--;
+        live_workers--;
+        return true;
+    }
+
+    // grow_on_submit: every worker is busy, so start one per new task (up to the upper bound)
+    void grow_for(size_t new_tasks) {
+        if (get_workers_count() >= upper_bound_workers) return;
+        std::lock_guard<std::mutex> lock(resize_mtx);
+        size_t current = live_workers.load() - retire_requests.load();
+        for (size_t i = 0; i < new_tasks && current < upper_bound_workers && !is_shutdown; ++i, ++current) {
+            spawn_worker();
+        }
+    }
+
+    // Keep-alive expiry: leave unless that would drop the pool below its lower bound
+    bool try_expire() {
+        std::lock_guard<std::mutex> lock(resize_mtx);
+        if (live_workers.load() - retire_requests.load() <= lower_bound_workers) return false;
+        live_workers--;
+        return true;
+    }
+
+    // Put a task back in the shared queue without admission. One claimed from
+    // the shared queue takes its slot back; one from a worker's deque never
+    // had a slot, so it doesn't take one now either.
+    void requeue(Task task, bool had_slot) {
+        if (max_queued > 0) {
+            if (had_slot) queued_slots.fetch_add(1, std::memory_order_seq_cst);
+            else unslotted_queued.fetch_add(1, std::memory_order_relaxed);
+        }
+        enqueue(std::move(task));
+    }
+
+    // Hand unstarted tasks to the other workers and free the slot
+    void retire(WorkerState& self) {
+        size_t handed_back = 0;
+        Task task;
+        Task* boxed;
+        while (self.deque.pop(boxed)) {
+            requeue(std::move(*boxed), false);
+            delete boxed;
+            ++handed_back;
+        }
+        while (self.batch.claim(task)) {
+            requeue(std::move(task), true);
+            ++handed_back;
+        }
+        if (handed_back > 0) notify_work(handed_back);
+        self.active.store(false, std::memory_order_release);
+    }
+
+    uint64_t total_tasks_started() {
+        uint64_t total = 0;
+        size_t n = slots_used.load(std::memory_order_acquire);
+        for (size_t i = 0; i < n; ++i) {
+            total += state_at(i)->tasks_started.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    // Every scale_interval, estimate how long the backlog takes to drain at the
+    // current start rate (Little's law). Past grow_after the workers are stuck,
+    // typically blocked in I/O, so add one; idle ones retire on their own via keep_alive.
+    void controller_loop() {
+        uint64_t last_started = total_tasks_started();
+        auto last_tick = std::chrono::steady_clock::now();
+
+        std::unique_lock<std::mutex> lock(controller_mtx);
+        while (!controller_cv.wait_for(lock, scale_interval, [this] { return is_shutdown.load(); })) {
+            auto now = std::chrono::steady_clock::now();
+            uint64_t started = total_tasks_started();
+            double rate = (started - last_started) / std::chrono::duration<double>(now - last_tick).count();
+            last_started = started;
+            last_tick = now;
+
+            size_t backlog = get_tasks_queued();
+            if (backlog == 0) continue;
+
+            double drain_seconds = rate > 0 ? backlog / rate : 1e9;
+            if (drain_seconds > std::chrono::duration<double>(grow_after).count()) {
+                std::lock_guard<std::mutex> resize_lock(resize_mtx);
+                if (!is_shutdown && live_workers.load() - retire_requests.load() < upper_bound_workers) {
+                    spawn_worker();
+                }
+            }
+        }
+    }
+
+    // The internal loop that every worker thread runs
+    void worker_loop(size_t index) {
+        this_thread_context() = ThreadContext{this, index};
+        WorkerState& self = *state_at(index);
+        if (!self.cpus.empty()) pin_current_thread(self.cpus);
+
+        while (true) {
+            // resize() asked for fewer workers: leave between tasks
+            if (retire_requests.load(std::memory_order_relaxed) > 0 && claim_retirement()) {
+                break;
+            }
+
+            Task task;
+
+            // Claim a task with a single queue operation; the pool lock is only
+            // taken when there is nothing to do and the worker has to sleep
+            if (next_task(index, task) ||
+                (idle_strategy == IdleStrategy::SpinThenPark && spin_for_work(index, task))) {
+                self.tasks_started.fetch_add(1, std::memory_order_relaxed);
+                if (self.tenant) {
+                    run_tenant_task(self, task);
+                } else {
+                    run_task(task);
+                }
+                continue;
+            }
+
+            ParkResult result = park();
+            if (result == ParkResult::Shutdown) {
+                live_workers--;
+                break;
+            }
+            if (result == ParkResult::Expired && try_expire()) {
+                break;
+            }
+        }
+
+        retire(self);
+    }
+
+    // =========================================
+    // MODULE 2f: Worker Placement
+    // =========================================
+    Placement placement;
+    CpuTopology topology;                        // Only detected when placement != None
+    std::vector<int> cpu_order;                  // Slot i runs on cpu_order[i % size] (Compact/Scatter/CpuList)
+    std::vector<size_t> shard_of_cpu;            // Logical CPU -> shard, for routing outside submits
+
+    // Decide once per slot where its workers run; a slot keeps its CPU when resize() reuses it
+    void place_slot(WorkerState& state, size_t index) {
+        if (placement == Placement::PerNumaNode) {
+            state.shard = index % shards.size();
+            state.cpus = topology.node_cpus(state.shard);
+        } else if (!cpu_order.empty()) {
+            state.cpus.assign(1, cpu_order[index % cpu_order.size()]);
+        }
+    }
+
+    // Shard a submit from the calling thread should land in: a worker's own
+    // shard, or the node of the CPU an outside thread is running on
+    size_t caller_shard() {
+        if (shards.size() == 1) return 0;
+
+        ThreadContext& ctx = this_thread_context();
+        if (ctx.pool == this) return state_at(ctx.index)->shard;
+
+        int cpu = current_cpu();
+        return (cpu >= 0 && (size_t)cpu < shard_of_cpu.size()) ? shard_of_cpu[cpu] : 0;
+    }
+
+    // =========================================
+    // MODULE 2g: Priority Lanes
+    // =========================================
+    static constexpr size_t kPriorityLanes = 4;
+    static constexpr size_t kUrgentLanes = (size_t)Priority::Normal + 1; // Served before the shared queue
+
+    PriorityLanes<Task, kPriorityLanes> lanes;
+
+    // Lanes [0, lane_limit): before anything else for the urgent ones, after
+    // the shared queue and stealing for Low
+    bool take_priority(Task& task, size_t lane_limit) {
+        if (!lanes.pop(task, lane_limit)) return false;
+        release_slots(1);
+        return true;
+    }
+
+    // DropOldest overflow: the oldest task of the lowest-priority non-empty lane
+    bool shed_lane_task(Task& task) {
+        if (!lanes.shed(task)) return false;
+        release_slots(1);
+        return true;
+    }
+
+    // =========================================
+    // MODULE 3c: Cancellation
+    // =========================================
+    std::atomic<uint64_t> cancelled_tasks{0};    // Skipped by a token or removed by cancel_all()
+
+    template <typename Inner>
+    CancellableTask<Inner> with_token(const CancellationToken& token, Inner inner) {
+        return CancellableTask<Inner>(std::move(inner), token, &cancelled_tasks);
+    }
+
+    // A task that will never run because of cancel_all() (or cancel_timer()):
+    // nobody asked for an error report
+    void drop_cancelled(Task& task, const char* reason = "ThreadPool::cancel_all() removed the task") {
+        try {
+            task.fail(std::make_exception_ptr(TaskCancelledError(reason)));
+        } catch (...) {
+            failed_tasks.fetch_add(1, std::memory_order_relaxed); // on_expire threw
+            handle_exception(std::current_exception());
+        }
+        task = Task();
+        cancelled_tasks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // =========================================
+    // MODULE 2h: Deadline Scheduling (EDF)
+    // =========================================
+    DeadlineQueue<Task> deadline_queue;
+    std::atomic<uint64_t> deadline_started{0};
+    std::atomic<uint64_t> deadline_shed{0};
+
+    // Earliest deadline first. Expired tasks sit at the top of the heap, so
+    // they are shed on the way to the first task that can still make it.
+    bool take_deadline(Task& task) {
+        if (deadline_queue.empty()) return false;
+
+        auto now = DeadlineQueue<Task>::Clock::now();
+        DeadlineQueue<Task>::Clock::time_point deadline;
+        while (deadline_queue.pop(task, deadline)) {
+            release_slots(1);
+            if (deadline >= now) {
+                deadline_started.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            shed_expired(task);
+        }
+        return false;
+    }
+
+    void shed_expired(Task& task) {
+        deadline_shed.fetch_add(1, std::memory_order_relaxed);
+        try {
+            fail_task(task, std::make_exception_ptr(DeadlineExpiredError("ThreadPool task expired before it started")));
+        } catch (...) {
+            failed_tasks.fetch_add(1, std::memory_order_relaxed); // on_expire threw
+            handle_exception(std::current_exception());
+        }
+        task = Task();
+    }
+
+    // DropOldest overflow: an expired deadline task, else the least urgent one
+    bool shed_deadline_task(Task& task) {
+        if (!deadline_queue.shed(task, DeadlineQueue<Task>::Clock::now())) return false;
+        release_slots(1);
+        return true;
+    }
+
+    void schedule_deadline(std::chrono::steady_clock::time_point deadline, Task task) {
+        if (admit(task)) {
+            deadline_queue.push(deadline, std::move(task));
+        }
+        notify_work();
+    }
+
+    // =========================================
+    // MODULE 2i: Blocking Regions
+    // =========================================
+    std::atomic<size_t> blocked_in_region{0};
+    size_t max_standins;
+
+    // Regions entered on this thread that actually took effect (nested ones don't)
+    static size_t& region_depth() {
+        static thread_local size_t depth = 0;
+        return depth;
+    }
+
+    // A worker is about to block: put a stand-in on its CPU slot. A stand-in
+    // from an earlier region that has not left yet is kept instead of
+    // starting a new thread; new ones are capped by max_standins.
+    bool enter_blocking() {
+        std::lock_guard<std::mutex> lock(resize_mtx);
+        if (is_shutdown) return false;
+        if (retire_requests.load() > 0) {
+            retire_requests--;
+        } else if (blocked_in_region.load() < max_standins && live_workers.load() < slot_capacity) {
+            spawn_worker();
+        } else {
+            return false;
+        }
+        blocked_in_region++;
+        return true;
+    }
+
+    // Back on the CPU: one worker (whichever gets there first) leaves
+    void leave_blocking() {
+        {
+            std::lock_guard<std::mutex> lock(resize_mtx);
+            blocked_in_region--;
+            if (is_shutdown) return;
+            retire_requests++;
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        size_t idle = idle_workers.load(std::memory_order_relaxed);
+        if (idle > 0) wake_idle(1, idle);
+    }
+
+
+    // =========================================
+    // MODULE 2j: Timers
+    // =========================================
+    // Delayed and periodic tasks wait in a timing wheel with 1ms ticks, served
+    // by one timer thread (started with the first timer). Due tasks go to the
+    // run queue as one batch per tick, so waiting costs no worker.
+    using TimerClock = std::chrono::steady_clock;
+    static constexpr TimerClock::duration kTimerTick = std::chrono::milliseconds(1);
+
+    std::mutex timer_mtx;
+    std::condition_variable timer_cv;
+    TimerWheel<Task> timer_wheel;
+    TimerClock::time_point timer_epoch = TimerClock::now(); // Tick 0
+    uint64_t timer_wake_tick = UINT64_MAX;  // Tick the timer thread sleeps until
+    bool timer_stop = false;
+    std::thread timer_thread;
+    std::atomic<uint64_t> timers_fired{0};
+
+    // First tick at or after 'when': a timer never fires early
+    uint64_t tick_at(TimerClock::time_point when) {
+        if (when <= timer_epoch) return 0;
+        return (uint64_t)((when - timer_epoch + kTimerTick - TimerClock::duration(1)) / kTimerTick);
+    }
+
+    // Re-runs the callable every 'period' until cancel_timer(). The next run is
+    // armed when this one returns, so runs never overlap; a run that overshoots
+    // its period is followed immediately rather than by a burst of catch-up runs.
+    template <typename F>
+    class PeriodicTask {
+    private:
+        ThreadPool* pool;
+        F fn;
+        TimerClock::duration period;
+        TimerClock::time_point due;
+
+    public:
+        TimerHandle handle;
+
+        PeriodicTask(ThreadPool* p, F f, TimerClock::duration every, TimerClock::time_point first)
+            : pool(p), fn(std::move(f)), period(every), due(first) {}
+
+        void operator()() {
+            try {
+                fn();
+            } catch (...) {
+                rearm();
+                throw;
+            }
+            rearm();
+        }
+
+        // Dropped by the pool (shutdown, cancel_all): retire the timer
+        void fail(std::exception_ptr) {
+            pool->retire_timer(handle);
+        }
+
+    private:
+        void rearm() {
+            due = std::max(due + period, TimerClock::now());
+            ThreadPool* p = pool;
+            TimerHandle h = handle;
+            TimerClock::time_point when = due;
+            p->rearm_timer(h, when, Task(std::move(*this))); // *this is moved-from below here
+        }
+    };
+
+    TimerHandle schedule_timer(TimerClock::time_point when, Task task, bool repeating = false) {
+        std::unique_lock<std::mutex> lock(timer_mtx);
+        if (timer_stop) {
+            lock.unlock();
+            drop_cancelled(task, "ThreadPool shut down before the timer fired");
+            return TimerHandle();
+        }
+        uint64_t tick = tick_at(when);
+        TimerHandle handle = timer_wheel.insert(tick, std::move(task), repeating);
+        start_timer_thread();
+        bool sooner = tick < timer_wake_tick;
+        lock.unlock();
+        if (sooner) timer_cv.notify_one();
+        return handle;
+    }
+
+    template <typename F>
+    TimerHandle schedule_periodic(TimerClock::duration period, F fn) {
+        TimerClock::time_point first = TimerClock::now() + period;
+        std::unique_lock<std::mutex> lock(timer_mtx);
+        if (timer_stop) return TimerHandle();
+        TimerHandle handle = timer_wheel.reserve();
+        PeriodicTask<F> task(this, std::move(fn), period, first);
+        task.handle = handle;
+        uint64_t tick = tick_at(first);
+        timer_wheel.rearm(handle, tick, Task(std::move(task)));
+        start_timer_thread();
+        bool sooner = tick < timer_wake_tick;
+        lock.unlock();
+        if (sooner) timer_cv.notify_one();
+        return handle;
+    }
+
+    void rearm_timer(TimerHandle handle, TimerClock::time_point when, Task task) {
+        std::unique_lock<std::mutex> lock(timer_mtx);
+        uint64_t tick = tick_at(when);
+        if (timer_stop || !timer_wheel.rearm(handle, tick, std::move(task))) return;
+        bool sooner = tick < timer_wake_tick;
+        lock.unlock();
+        if (sooner) timer_cv.notify_one();
+    }
+
+    void retire_timer(TimerHandle handle) {
+        std::lock_guard<std::mutex> lock(timer_mtx);
+        Task ignored;
+        timer_wheel.cancel(handle, ignored);
+        timer_wheel.rearm(handle, 0, Task());  // Frees a parked node; no-op otherwise
+    }
+
+    // Caller holds timer_mtx
+    void start_timer_thread() {
+        if (!timer_thread.joinable()) {
+            timer_thread = std::thread(&ThreadPool::timer_loop, this);
+        }
+    }
+
+    void timer_loop() {
+        std::vector<Task> due;
+        std::unique_lock<std::mutex> lock(timer_mtx);
+        while (!timer_stop) {
+            uint64_t now = (uint64_t)((TimerClock::now() - timer_epoch) / kTimerTick);
+            timer_wheel.advance(now, [&due](TimerHandle, Task&& task) { due.push_back(std::move(task)); });
+
+            if (!due.empty()) {
+                lock.unlock();
+                size_t n = due.size();
+                timers_fired.fetch_add(n, std::memory_order_relaxed);
+                schedule_bulk(due);
+                notify_work(n);
+                due.clear();
+                lock.lock();
+                continue;
+            }
+
+            timer_wake_tick = timer_wheel.next_tick();
+            if (timer_wake_tick == UINT64_MAX) {
+                timer_cv.wait(lock);
+            } else {
+                timer_cv.wait_until(lock, timer_epoch + kTimerTick * timer_wake_tick);
+            }
+            timer_wake_tick = 0;            // Awake: inserts need not notify
+        }
+    }
+
+    // Shutdown: timers that have not fired are dropped like cancelled tasks
+    void stop_timers() {
+        std::vector<Task> dropped;
+        {
+            std::lock_guard<std::mutex> lock(timer_mtx);
+            timer_stop = true;
+            timer_wheel.clear([&dropped](Task&& task) { dropped.push_back(std::move(task)); });
+        }
+        timer_cv.notify_all();
+        if (timer_thread.joinable()) timer_thread.join();
+        for (Task& task : dropped) drop_cancelled(task, "ThreadPool shut down before the timer fired");
+    }
 
     // =========================================
-    // MODULE 2: Worker Thread Engine
+    // MODULE 2k: Task Classes
     // =========================================
-    std::vector<std::thread> workers;            // The pool of threads
-    SafeQueue<std::function<void()>> task_queue; // Queue holds "void" functions
+    // A class task holds one of its class's slots (and used one rate token)
+    // from dispatch until it is destroyed, i.e. until it ran or was dropped.
+    // Tasks over the limits wait in the class's own queue, outside the pool's
+    // queues, and whoever frees a slot (or the refill timer, when the rate is
+    // the limit) moves the next ones over; only atomics on that path.
+    std::mutex classes_mtx;
+    std::unordered_map<std::string, std::unique_ptr<TaskClassState>> classes;
 
-    // The internal loop that every worker thread runs
-    void worker_loop() {
+    template <typename Inner>
+    class PermitTask {
+    private:
+        ThreadPool* pool;
+        TaskClassState* cls;            // Null once moved from
+        Inner inner;
+
+    public:
+        PermitTask(ThreadPool* p, TaskClassState* c, Inner i) : pool(p), cls(c), inner(std::move(i)) {}
+
+        PermitTask(PermitTask&& other) noexcept
+            : pool(other.pool), cls(std::exchange(other.cls, nullptr)), inner(std::move(other.inner)) {}
+
+        PermitTask& operator=(PermitTask&&) = delete;
+
+        ~PermitTask() {
+            if (cls) pool->release_slot(cls);
+        }
+
+        void operator()() {
+            inner();
+        }
+
+        template <typename I = Inner, typename = typename std::enable_if<task_has_fail<I>::value>::type>
+        void fail(std::exception_ptr error) {
+            inner.fail(error);
+        }
+    };
+
+    // Slot first, then a rate token. 'retry_at' is set (ns) when the rate said no.
+    bool acquire_slot(TaskClassState* cls, int64_t& retry_at) {
+        if (!cls->try_take_slot()) return false;
+        if (!cls->rate.try_acquire(retry_at)) {
+            cls->running.fetch_sub(1, std::memory_order_seq_cst);
+            return false;
+        }
+        cls->started.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void release_slot(TaskClassState* cls) {
+        cls->running.fetch_sub(1, std::memory_order_seq_cst);
+        if (cls->parked.load(std::memory_order_seq_cst) > 0) pump_class(cls);
+    }
+
+    bool class_has_room(TaskClassState* cls) {
+        size_t cap = cls->max_concurrent.load(std::memory_order_relaxed);
+        return cap == 0 || cls->running.load(std::memory_order_seq_cst) < cap;
+    }
+
+    template <typename Inner>
+    void schedule_in_class(TaskClassState* cls, Inner inner) {
+        int64_t retry_at = 0;
+        if (cls->parked.load(std::memory_order_seq_cst) == 0 && acquire_slot(cls, retry_at)) {
+            schedule(PermitTask<Inner>(this, cls, std::move(inner)));
+            notify_work();
+            return;
+        }
+        cls->throttled.fetch_add(1, std::memory_order_relaxed);
+        cls->queue.push(Task(std::move(inner)));
+        cls->parked.fetch_add(1, std::memory_order_seq_cst);
+        pump_class(cls);
+    }
+
+    // Move parked tasks to the pool while the limits allow. One pumper at a
+    // time (it is the queue's consumer); a caller that finds another one at
+    // work leaves, and the pumper re-checks after letting go, so freed room
+    // or a new arrival is never missed.
+    void pump_class(TaskClassState* cls) {
         while (true) {
-            std::function<void()> task;
-            {
-                // Wait for a task or shutdown signal
-                std::unique_lock<std::mutex> lock(mtx);
-                cv.wait(lock, [this] { 
-                    return !task_queue.empty() || is_shutdown; 
-                });
-
-                // Exit if shutdown is triggered and queue is empty
-                if (is_shutdown && task_queue.empty()) {
-                    return;
-                }
+            if (cls->pumping.exchange(true, std::memory_order_seq_cst)) return;
 
-                // If queue is not empty, grab the task
-                // We don't need to lock here because SafeQueue handles its own locking!
-                if (!task_queue.pop(task)) {
-                    continue; 
+            int64_t retry_at = 0;
+            bool missed = false;
+            while (cls->parked.load(std::memory_order_seq_cst) > 0 && acquire_slot(cls, retry_at)) {
+                Task task;
+                if (!cls->queue.pop(task)) {
+                    // A push still in progress; its producer pumps when done
+                    cls->rate.refund();
+                    cls->started.fetch_sub(1, std::memory_order_relaxed);
+                    cls->running.fetch_sub(1, std::memory_order_seq_cst);
+                    missed = true;
+                    break;
                 }
+                cls->parked.fetch_sub(1, std::memory_order_seq_cst);
+                schedule(PermitTask<Task>(this, cls, std::move(task)));
+                notify_work();
             }
+            cls->pumping.store(false, std::memory_order_seq_cst);
 
-            // Execute the task outside the lock (for performance)
-            task();
+            if (missed) return;
+            if (retry_at != 0) {
+                arm_class_refill(cls, retry_at);
+                return;
+            }
+            if (cls->parked.load(std::memory_order_seq_cst) == 0 || !class_has_room(cls)) return;
+        }
+    }
+
+    // Rate-limited with tasks parked: pump again when the next token is due
+    void arm_class_refill(TaskClassState* cls, int64_t at_ns) {
+        if (cls->refill_armed.exchange(true, std::memory_order_acq_rel)) return;
+        auto at = std::chrono::steady_clock::time_point(std::chrono::nanoseconds(at_ns));
+        post_at(at, [this, cls] {
+            cls->refill_armed.store(false, std::memory_order_release);
+            pump_class(cls);
+        });
+    }
+
+    // Take every parked task of every class (cancel_all(), shutdown)
+    template <typename Fn>
+    size_t drain_parked(Fn&& drop) {
+        size_t removed = 0;
+        std::lock_guard<std::mutex> lock(classes_mtx);
+        for (auto& entry : classes) {
+            TaskClassState* cls = entry.second.get();
+            while (cls->pumping.exchange(true, std::memory_order_seq_cst)) std::this_thread::yield();
+            Task task;
+            while (cls->queue.pop(task)) {
+                cls->parked.fetch_sub(1, std::memory_order_seq_cst);
+                drop(task);
+                ++removed;
+            }
+            cls->pumping.store(false, std::memory_order_seq_cst);
         }
+        return removed;
+    }
+
+    // =========================================
+    // MODULE 2l: Tenant Scheduling
+    // =========================================
+    // Each tenant queues in its own FIFO and workers pick the next tenant by
+    // deficit round robin over run time (TenantScheduler), so a tenant
+    // flooding the pool waits behind its own backlog, not everyone else's.
+    // Once the first tenant exists, untagged work from outside the pool goes
+    // to the "default" tenant instead of the shared queue, so it takes its
+    // turn too; the shared queue then only drains what was queued before.
+    // Tenant queues count against max_queued like the shared queue.
+    TenantScheduler tenants;
+    TenantState* default_tenant;
+    std::atomic<bool> tenants_active{false};
+
+    void schedule_tenant(TenantState* tenant, Task task) {
+        if (admit(task)) {
+            tenants.push(tenant, std::move(task));
+        }
+    }
+
+    bool take_tenant(WorkerState& self, Task& task) {
+        if (!tenants.pop(task, self.tenant, self.tenant_charge)) return false;
+        release_slots(1);
+        return true;
+    }
+
+    // Run time goes back to the scheduler, settling what pop() charged
+    void run_tenant_task(WorkerState& self, Task& task) {
+        auto started = std::chrono::steady_clock::now();
+        run_task(task);
+        int64_t ran = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started).count();
+        tenants.complete(self.tenant, self.tenant_charge, ran);
+        self.tenant = nullptr;
+    }
+
+    // DropOldest overflow: the oldest task of the tenant with the longest queue
+    bool shed_tenant_task(Task& task) {
+        if (!tenants.shed(task)) return false;
+        release_slots(1);
+        return true;
     }
 
 public:
     // Constructor: Launches 'n' worker threads
-    ThreadPool(size_t threads_count) : is_shutdown(false) {
-        for (size_t i = 0; i < threads_count; ++i) {
-            workers.emplace_back(&ThreadPool::worker_loop, this);
+    ThreadPool(size_t threads_count, PoolOptions options = PoolOptions())
+        : is_shutdown(false), idle_strategy(options.idle_strategy), spin_polls(options.spin_polls),
+          yield_polls(options.yield_polls), exception_handler(std::move(options.exception_handler)),
+          max_queued(options.max_queued), overflow_policy(options.overflow_policy),
+          overflow_timeout(options.overflow_timeout), mode(options.mode),
+          dequeue_batch(std::min(std::max<size_t>(options.dequeue_batch, 1), TaskBatch<Task>::kMaxBatch)),
+          elastic(options.max_threads > 0), grow_on_submit(elastic && options.grow_on_submit),
+          grow_after(options.grow_after),
+          keep_alive(options.keep_alive), scale_interval(options.scale_interval),
+          placement(options.placement), lanes(options.priority_aging), tenants(options.tenant_quantum, std::max<size_t>(options.max_tenants, 1)) {
+        default_tenant = tenants.get("default");
+        if (placement != Placement::None) {
+            topology = CpuTopology::detect();
+        }
+        switch (placement) {
+        case Placement::Compact:     cpu_order = topology.compact_order(); break;
+        case Placement::Scatter:     cpu_order = topology.scatter_order(); break;
+        case Placement::CpuList:     cpu_order = options.cpu_list; break;
+        default: break;
+        }
+
+        size_t shard_count = placement == Placement::PerNumaNode ? topology.node_count() : 1;
+        for (size_t i = 0; i < shard_count; ++i) {
+            shards.emplace_back(new QueueShard());
+            if (options.queue_kind == QueueKind::LockFree) {
+                shards.back()->ring_queue.reset(new LockFreeQueue<Task>(options.queue_capacity));
+            }
+        }
+        if (shard_count > 1) {
+            for (const CpuInfo& info : topology.cpus()) {
+                if ((size_t)info.cpu >= shard_of_cpu.size()) shard_of_cpu.resize(info.cpu + 1, 0);
+                shard_of_cpu[info.cpu] = info.node;
+            }
+        }
+
+        threads_count = std::max<size_t>(threads_count, 1);
+        slot_capacity = std::max({kMaxWorkers, threads_count, options.max_threads});
+        worker_slots.reset(new std::atomic<WorkerState*>[slot_capacity]);
+        for (size_t i = 0; i < slot_capacity; ++i) worker_slots[i].store(nullptr);
+
+        max_standins = options.max_blocking_standins > 0 ? options.max_blocking_standins
+                                                         : std::max(threads_count, options.max_threads);
+
+        if (elastic) {
+            lower_bound_workers = std::max<size_t>(1, std::min(options.min_threads, threads_count));
+            upper_bound_workers = std::max(options.max_threads, threads_count);
+        } else {
+            lower_bound_workers = 1;
+            upper_bound_workers = slot_capacity;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(resize_mtx);
+            for (size_t i = 0; i < threads_count; ++i) {
+                spawn_worker();
+            }
+        }
+        if (elastic) {
+            controller = std::thread(&ThreadPool::controller_loop, this);
         }
     }
 
     // NEW FEATURE: Monitoring Interface (Module 3)
     size_t get_tasks_queued() {
-        return task_queue.size();
+        size_t queued = lanes.size() + deadline_queue.size() + tenants.size();
+        for (auto& shard : shards) {
+            queued += shard->size();
+        }
+        size_t n = slots_used.load(std::memory_order_acquire);
+        for (size_t i = 0; i < n; ++i) {
+            WorkerState* state = state_at(i);
+            queued += state->deque.size() + state->batch.unclaimed();
+        }
+        return queued;
+    }
+
+    LaneStats get_lane_stats(Priority priority) {
+        size_t lane = (size_t)priority;
+        const LatencyHistogram& latency = lanes.lane_latency(lane);
+        LaneStats stats;
+        stats.queued = lanes.lane_size(lane);
+        stats.started = latency.count();
+        stats.promoted = lanes.lane_promotions(lane);
+        stats.p50_us = latency.percentile_us(0.50);
+        stats.p90_us = latency.percentile_us(0.90);
+        stats.p95_us = latency.percentile_us(0.95);
+        stats.p99_us = latency.percentile_us(0.99);
+        return stats;
+    }
+
+    DeadlineStats get_deadline_stats() {
+        DeadlineStats stats;
+        stats.started = deadline_started.load(std::memory_order_relaxed);
+        stats.shed = deadline_shed.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    // Tasks that never ran because they were cancelled (token or cancel_all())
+    size_t get_tasks_cancelled() {
+        return cancelled_tasks.load(std::memory_order_relaxed);
     }
 
     size_t get_workers_count() {
-        return workers.size();
+        return live_workers.load() - retire_requests.load();
+    }
+
+    // Grow or shrink to 'n' workers (clamped to [min_threads, max_threads] for an
+    // elastic pool, [1, 256] otherwise). New workers start right away; surplus
+    // workers leave after their current task and hand their queued work back.
+    void resize(size_t n) {
+        {
+            std::lock_guard<std::mutex> lock(resize_mtx);
+            if (is_shutdown) return;
+
+            n = std::min(std::max(n, lower_bound_workers), upper_bound_workers);
+            size_t current = live_workers.load() - retire_requests.load();
+
+            if (n >= current) {
+                size_t cancelled = std::min(retire_requests.load(), n - current);
+                retire_requests -= cancelled;
+                for (current += cancelled; current < n; ++current) {
+                    spawn_worker();
+                }
+                return;
+            }
+            retire_requests += current - n;
+        }
+        wake_all_workers(); // Parked workers must wake up to retire
+    }
+
+    size_t get_tasks_failed() {
+        return failed_tasks.load(std::memory_order_relaxed);
+    }
+
+    OverflowStats get_overflow_stats() {
+        OverflowStats stats;
+        stats.blocked = overflow_counts.blocked.load();
+        stats.timed_out = overflow_counts.timed_out.load();
+        stats.rejected = overflow_counts.rejected.load();
+        stats.dropped = overflow_counts.dropped.load();
+        stats.caller_ran = overflow_counts.caller_ran.load();
+        return stats;
     }
 
     // Destructor: Joins all threads
     ~ThreadPool() {
         shutdown();
+        size_t n = slots_used.load();
+        for (size_t i = 0; i < n; ++i) {
+            delete state_at(i);
+        }
     }
 
     // Function to submit tasks (Module 3 API)
@@ -80,22 +1591,491 @@ public:
         
         using return_type = typename std::invoke_result<F, Args...>::type;
 
-        // Package the task so we can get a future result back later
-        auto task = std::make_shared<std::packaged_task<return_type()>>(
-            std::bind(std::forward<F>(f), std::forward<Args>(args)...)
-        );
-        
-        std::future<return_type> res = task->get_future();
+        // Package the task so we can get a future result back later.
+        // Callable, arguments and promise travel together inside one move-only Task.
+        std::promise<return_type> promise;
+        std::future<return_type> res = promise.get_future();
 
-        // Push a simple void wrapper into the queue
-        task_queue.push([task]() { (*task)(); });
+        schedule(PromiseTask<return_type, typename std::decay<F>::type, typename std::decay<Args>::type...>(
+            std::move(promise), std::forward<F>(f), std::forward<Args>(args)...
+        ));
 
-        // Wake up one thread to handle this new task
-        cv.notify_one();
+        // Wake up one thread to handle this new task (no-op when none is parked)
+        notify_work();
         
         return res;
     }
 
+    // Like submit(), but queued in a priority lane: Critical and High run before
+    // any plain submit()ted work, Low only once the shared queue is drained.
+    // Waiting tasks age upward as far as High (PoolOptions::priority_aging).
+    template<class F, class... Args>
+    auto submit_with_priority(Priority priority, F&& f, Args&&... args)
+        -> std::future<typename std::invoke_result<F, Args...>::type> {
+
+        using return_type = typename std::invoke_result<F, Args...>::type;
+
+        std::promise<return_type> promise;
+        std::future<return_type> res = promise.get_future();
+
+        Task task(PromiseTask<return_type, typename std::decay<F>::type, typename std::decay<Args>::type...>(
+            std::move(promise), std::forward<F>(f), std::forward<Args>(args)...
+        ));
+        if (admit(task)) {
+            lanes.push((size_t)priority, std::move(task));
+        }
+        notify_work();
+
+        return res;
+    }
+
+    // Deadline scheduling: tasks with a deadline run earliest-deadline-first
+    // (after Critical..Normal priority lanes, before plain submit()ted work).
+    // A task still queued at its deadline is not run; its future gets
+    // DeadlineExpiredError instead, and get_deadline_stats() counts it as shed.
+    template<class F, class... Args>
+    auto submit_with_deadline(std::chrono::steady_clock::time_point deadline, F&& f, Args&&... args)
+        -> std::future<typename std::invoke_result<F, Args...>::type> {
+
+        using return_type = typename std::invoke_result<F, Args...>::type;
+
+        std::promise<return_type> promise;
+        std::future<return_type> res = promise.get_future();
+
+        schedule_deadline(deadline, PromiseTask<return_type, typename std::decay<F>::type, typename std::decay<Args>::type...>(
+            std::move(promise), std::forward<F>(f), std::forward<Args>(args)...
+        ));
+        return res;
+    }
+
+    // Fire-and-forget counterpart: on_expire() runs on a worker in place of f
+    // if the deadline passes first
+    template<class OnExpire, class F, class... Args>
+    void post_with_deadline(std::chrono::steady_clock::time_point deadline, OnExpire&& on_expire, F&& f, Args&&... args) {
+        using Inner = BoundTask<typename std::decay<F>::type, typename std::decay<Args>::type...>;
+        schedule_deadline(deadline, ExpiringTask<typename std::decay<OnExpire>::type, Inner>(
+            std::forward<OnExpire>(on_expire), Inner(std::forward<F>(f), std::forward<Args>(args)...)
+        ));
+    }
+
+    // Delayed and periodic tasks (see MODULE 2j). Nothing holds a worker while
+    // a timer waits; resolution is 1ms and a timer never fires early.
+    template<class F, class... Args>
+    auto submit_at(std::chrono::steady_clock::time_point when, F&& f, Args&&... args)
+        -> std::future<typename std::invoke_result<F, Args...>::type> {
+
+        using return_type = typename std::invoke_result<F, Args...>::type;
+
+        std::promise<return_type> promise;
+        std::future<return_type> res = promise.get_future();
+
+        schedule_timer(when, PromiseTask<return_type, typename std::decay<F>::type, typename std::decay<Args>::type...>(
+            std::move(promise), std::forward<F>(f), std::forward<Args>(args)...
+        ));
+        return res;
+    }
+
+    template<class Rep, class Period, class F, class... Args>
+    auto submit_after(std::chrono::duration<Rep, Period> delay, F&& f, Args&&... args)
+        -> std::future<typename std::invoke_result<F, Args...>::type> {
+        return submit_at(std::chrono::steady_clock::now() + delay, std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    // Fire-and-forget counterparts that can be cancelled with cancel_timer()
+    template<class F, class... Args>
+    TimerHandle post_at(std::chrono::steady_clock::time_point when, F&& f, Args&&... args) {
+        return schedule_timer(when, BoundTask<typename std::decay<F>::type, typename std::decay<Args>::type...>(
+            std::forward<F>(f), std::forward<Args>(args)...
+        ));
+    }
+
+    template<class Rep, class Period, class F, class... Args>
+    TimerHandle post_after(std::chrono::duration<Rep, Period> delay, F&& f, Args&&... args) {
+        return post_at(std::chrono::steady_clock::now() + delay, std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    // Run f(args...) every 'period', first one period from now, until
+    // cancel_timer(). A run starts no earlier than 'period' after the previous
+    // one was due, and never while the previous one is still running.
+    template<class Rep, class Period, class F, class... Args>
+    TimerHandle submit_every(std::chrono::duration<Rep, Period> period, F&& f, Args&&... args) {
+        auto every = std::max<TimerClock::duration>(std::chrono::duration_cast<TimerClock::duration>(period), kTimerTick);
+        // Unlike BoundTask, keeps callable and arguments for the next run
+        return schedule_periodic(every, [fn = std::forward<F>(f), bound = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+            std::apply(fn, bound);
+        });
+    }
+
+    // O(1). True if the timer had not fired yet (a submit_every timer: will not
+    // fire again). A removed post_at/post_after task is dropped like a
+    // cancel_all() one.
+    bool cancel_timer(TimerHandle handle) {
+        Task task;
+        bool cancelled;
+        {
+            std::lock_guard<std::mutex> lock(timer_mtx);
+            cancelled = timer_wheel.cancel(handle, task);
+        }
+        if (task) drop_cancelled(task, "ThreadPool::cancel_timer() removed the task");
+        return cancelled;
+    }
+
+    // Timers waiting to fire
+    size_t get_timers_pending() {
+        std::lock_guard<std::mutex> lock(timer_mtx);
+        return timer_wheel.size();
+    }
+
+    // Timer tasks handed to the run queue so far (each periodic run counts)
+    uint64_t get_timers_fired() {
+        return timers_fired.load(std::memory_order_relaxed);
+    }
+
+    // Cancellable submission: if 'token' is cancelled before a worker starts the
+    // task, it is skipped and the future gets TaskCancelledError. A running task
+    // can poll the same token (capture it) to stop early.
+    template<class F, class... Args>
+    auto submit(const CancellationToken& token, F&& f, Args&&... args)
+        -> std::future<typename std::invoke_result<F, Args...>::type> {
+
+        using return_type = typename std::invoke_result<F, Args...>::type;
+
+        std::promise<return_type> promise;
+        std::future<return_type> res = promise.get_future();
+
+        schedule(with_token(token, PromiseTask<return_type, typename std::decay<F>::type, typename std::decay<Args>::type...>(
+            std::move(promise), std::forward<F>(f), std::forward<Args>(args)...
+        )));
+        notify_work();
+
+        return res;
+    }
+
+    template<class F, class... Args>
+    void post(const CancellationToken& token, F&& f, Args&&... args) {
+        schedule(with_token(token, BoundTask<typename std::decay<F>::type, typename std::decay<Args>::type...>(
+            std::forward<F>(f), std::forward<Args>(args)...
+        )));
+        notify_work();
+    }
+
+    // Task classes: tasks submitted under a class start only while the class
+    // is below its concurrency cap and has a rate token (TaskClassLimits).
+    // The rest wait in the class's own queue without holding a worker, so
+    // throttled and unthrottled work can share the pool. Parked tasks are not
+    // in get_tasks_queued() (they are not work the pool could start); see
+    // get_class_stats().
+    //
+    //     TaskClass db = pool.task_class("db", {8, 500});  // <= 8 at once, 500/s
+    //     pool.submit(db, [&] { return query(sql); });
+    //
+    // Called again with limits, it changes them for tasks not yet started.
+    TaskClass task_class(const std::string& name, const TaskClassLimits& limits) {
+        TaskClassState* cls;
+        {
+            std::lock_guard<std::mutex> lock(classes_mtx);
+            std::unique_ptr<TaskClassState>& slot = classes[name];
+            if (!slot) slot.reset(new TaskClassState(name));
+            cls = slot.get();
+        }
+        cls->max_concurrent.store(limits.max_concurrent, std::memory_order_relaxed);
+        cls->rate.configure(limits.rate_per_second, limits.burst);
+        if (cls->parked.load(std::memory_order_seq_cst) > 0) pump_class(cls); // Limits may have gone up
+        return TaskClass(cls);
+    }
+
+    // Existing class by name (created without limits if new)
+    TaskClass task_class(const std::string& name) {
+        std::lock_guard<std::mutex> lock(classes_mtx);
+        std::unique_ptr<TaskClassState>& slot = classes[name];
+        if (!slot) slot.reset(new TaskClassState(name));
+        return TaskClass(slot.get());
+    }
+
+    template<class F, class... Args>
+    auto submit(const TaskClass& task_class, F&& f, Args&&... args)
+        -> std::future<typename std::invoke_result<F, Args...>::type> {
+
+        using return_type = typename std::invoke_result<F, Args...>::type;
+
+        std::promise<return_type> promise;
+        std::future<return_type> res = promise.get_future();
+
+        schedule_in_class(task_class.state, PromiseTask<return_type, typename std::decay<F>::type, typename std::decay<Args>::type...>(
+            std::move(promise), std::forward<F>(f), std::forward<Args>(args)...
+        ));
+        return res;
+    }
+
+    template<class F, class... Args>
+    void post(const TaskClass& task_class, F&& f, Args&&... args) {
+        schedule_in_class(task_class.state, BoundTask<typename std::decay<F>::type, typename std::decay<Args>::type...>(
+            std::forward<F>(f), std::forward<Args>(args)...
+        ));
+    }
+
+    TaskClassStats get_class_stats(const TaskClass& task_class) {
+        TaskClassState* cls = task_class.state;
+        TaskClassStats stats;
+        stats.running = cls->running.load(std::memory_order_relaxed);
+        stats.parked = cls->parked.load(std::memory_order_relaxed);
+        stats.started = cls->started.load(std::memory_order_relaxed);
+        stats.throttled = cls->throttled.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    // Tenants: work submitted for a tenant waits in the tenant's own queue,
+    // and workers share themselves out between tenants with queued work in
+    // proportion to their weights, measured in run time. A tenant that floods
+    // the pool only delays itself; one with a few tasks gets them started
+    // within about a round (a quantum per busy tenant). From the first
+    // tenant() call on, plain submit()/post() work from outside the pool is
+    // the "default" tenant's (weight 1; tenant("default") to change it), so
+    // a tagged flood can't starve it either. Tasks a work-stealing worker
+    // spawns stay on its own deque and are not scheduled by tenant.
+    //
+    //     Tenant acme = pool.tenant("acme", 4);   // 4x the share of a weight-1 tenant
+    //     pool.post(acme, [=] { handle(request); });
+    //
+    // Weights can change at any time (set_tenant_weight(), or tenant() again
+    // with a weight) and apply from the tenant's next round. A tenant lives
+    // as long as the pool; past PoolOptions::max_tenants, tenant() throws
+    // std::length_error for new names.
+    Tenant tenant(const std::string& name, unsigned weight) {
+        Tenant handle = tenant(name);
+        tenants.set_weight(handle.state, weight);
+        return handle;
+    }
+
+    // Existing tenant by name (weight 1 if new)
+    Tenant tenant(const std::string& name) {
+        TenantState* state = tenants.get(name);
+        if (!state) throw std::length_error("ThreadPool: too many tenants");
+        tenants_active.store(true, std::memory_order_release);
+        return Tenant(state);
+    }
+
+    void set_tenant_weight(const Tenant& tenant, unsigned weight) {
+        tenants.set_weight(tenant.state, weight);
+    }
+
+    template<class F, class... Args>
+    auto submit(const Tenant& tenant, F&& f, Args&&... args)
+        -> std::future<typename std::invoke_result<F, Args...>::type> {
+
+        using return_type = typename std::invoke_result<F, Args...>::type;
+
+        std::promise<return_type> promise;
+        std::future<return_type> res = promise.get_future();
+
+        schedule_tenant(tenant.state, PromiseTask<return_type, typename std::decay<F>::type, typename std::decay<Args>::type...>(
+            std::move(promise), std::forward<F>(f), std::forward<Args>(args)...
+        ));
+        notify_work();
+
+        return res;
+    }
+
+    template<class F, class... Args>
+    void post(const Tenant& tenant, F&& f, Args&&... args) {
+        schedule_tenant(tenant.state, BoundTask<typename std::decay<F>::type, typename std::decay<Args>::type...>(
+            std::forward<F>(f), std::forward<Args>(args)...
+        ));
+        notify_work();
+    }
+
+    TenantStats get_tenant_stats(const Tenant& tenant) {
+        return tenants.stats(tenant.state);
+    }
+
+    // Splitting hint for parallel algorithms: true when a piece of work handed
+    // off now would likely be picked up right away, because a worker is parked
+    // or (on a work-stealing worker) the caller's own deque is empty
+    bool needs_work() {
+        if (idle_workers.load(std::memory_order_relaxed) > 0) return true;
+        WorkerState* local = local_worker();
+        return local && local->deque.empty();
+    }
+
+    // Remove every task that has not started yet, from every queue, lane,
+    // worker deque, tenant and task class. Futures get TaskCancelledError; running tasks are not
+    // interrupted. Returns how many tasks were removed.
+    size_t cancel_all() {
+        size_t removed = 0;
+        Task task;
+        Task* boxed;
+        DeadlineQueue<Task>::Clock::time_point deadline;
+        auto drop = [this, &removed](Task& t) {
+            drop_cancelled(t);
+            ++removed;
+        };
+
+        drain_parked(drop);             // First, so no pump moves them into the queues behind us
+
+        for (size_t i = 0; i < shards.size(); ++i) {
+            while (dequeue_from(i, task)) drop(task);
+        }
+        while (lanes.discard(task)) {
+            release_slots(1);
+            drop(task);
+        }
+        while (deadline_queue.pop(task, deadline)) {
+            release_slots(1);
+            drop(task);
+        }
+        while (shed_tenant_task(task)) drop(task);
+
+        size_t n = slots_used.load(std::memory_order_acquire);
+        for (size_t i = 0; i < n; ++i) {
+            WorkerState* state = state_at(i);
+            while (state->deque.steal(boxed)) {
+                unbox(boxed, task);
+                drop(task);
+            }
+            while (state->batch.claim(task)) drop(task);
+        }
+        return removed;
+    }
+
+    // Scope guard returned by blocking_region()
+    class BlockingRegion {
+    private:
+        ThreadPool* pool;
+
+    public:
+        explicit BlockingRegion(ThreadPool* p) : pool(p) {}
+        BlockingRegion(BlockingRegion&& other) noexcept : pool(other.pool) { other.pool = nullptr; }
+        BlockingRegion(const BlockingRegion&) = delete;
+        BlockingRegion& operator=(const BlockingRegion&) = delete;
+        BlockingRegion& operator=(BlockingRegion&&) = delete;
+
+        ~BlockingRegion() {
+            if (pool) {
+                --region_depth();
+                pool->leave_blocking();
+            }
+        }
+    };
+
+    // Mark blocking code (I/O, sleeps, lock waits) inside a task:
+    //     { auto region = pool.blocking_region(); read(fd, buf, n); }
+    // On a worker of this pool another worker takes over the CPU slot until
+    // the region ends, then one worker retires again. Nested regions, calls
+    // from other threads and regions past PoolOptions::max_blocking_standins
+    // (default: as many as the pool has workers) do nothing.
+    BlockingRegion blocking_region() {
+        if (this_thread_context().pool != this || region_depth() > 0 || !enter_blocking()) {
+            return BlockingRegion(nullptr);
+        }
+        ++region_depth();
+        return BlockingRegion(this);
+    }
+
+    // Workers currently inside a blocking_region()
+    size_t get_blocked_workers() {
+        return blocked_in_region.load(std::memory_order_relaxed);
+    }
+
+#ifdef THREAD_POOL_COROUTINES
+    // Awaitable returned by schedule(). The suspended coroutine is queued as a
+    // plain task and holds no thread until a worker resumes it.
+    class ScheduleAwaiter {
+    private:
+        ThreadPool& pool;
+        std::exception_ptr error;
+
+        struct Resume {
+            std::coroutine_handle<> handle;
+            ScheduleAwaiter* awaiter;
+
+            void operator()() {
+                handle.resume();
+            }
+
+            // Dropped (cancel_all, full queue): resume right here and let the co_await throw
+            void fail(std::exception_ptr e) {
+                awaiter->error = e;
+                handle.resume();
+            }
+        };
+
+    public:
+        explicit ScheduleAwaiter(ThreadPool& p) : pool(p) {}
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            pool.post(Resume{handle, this});
+        }
+
+        void await_resume() {
+            if (error) std::rethrow_exception(error);
+        }
+    };
+
+    // co_await pool.schedule(): the rest of the coroutine runs on a worker
+    ScheduleAwaiter schedule() {
+        return ScheduleAwaiter(*this);
+    }
+#endif
+
+    // Fire-and-forget submission: no promise, no future, no shared state.
+    // If the task throws, the pool's exception_handler sees it (see PoolOptions).
+    // (The return type only keeps post(token, f, ...), post(task_class, f, ...) and
+    // post(tenant, f, ...) from matching here.)
+    template<class F, class... Args>
+    auto post(F&& f, Args&&... args)
+        -> typename std::enable_if<!std::is_same<typename std::decay<F>::type, CancellationToken>::value &&
+                                   !std::is_same<typename std::decay<F>::type, TaskClass>::value &&
+                                   !std::is_same<typename std::decay<F>::type, Tenant>::value>::type {
+        if constexpr (sizeof...(Args) == 0) {
+            schedule(Task(std::forward<F>(f)));
+        } else {
+            schedule(BoundTask<typename std::decay<F>::type, typename std::decay<Args>::type...>(
+                std::forward<F>(f), std::forward<Args>(args)...
+            ));
+        }
+        notify_work();
+    }
+
+    // Bulk submission: fn(element) for every element of [first, last).
+    // The batch is queued in one step and wakes at most min(batch, idle workers) threads.
+    template<class InputIt, class F>
+    auto submit_bulk(InputIt first, InputIt last, F fn)
+        -> std::vector<std::future<typename std::invoke_result<F, typename std::iterator_traits<InputIt>::value_type>::type>> {
+
+        using value_type = typename std::iterator_traits<InputIt>::value_type;
+        using return_type = typename std::invoke_result<F, value_type>::type;
+
+        std::vector<std::future<return_type>> results;
+        std::vector<Task> batch;
+        for (; first != last; ++first) {
+            std::promise<return_type> promise;
+            results.push_back(promise.get_future());
+            batch.emplace_back(PromiseTask<return_type, F, value_type>(std::move(promise), fn, *first));
+        }
+
+        schedule_bulk(batch);
+        notify_work(batch.size());
+        return results;
+    }
+
+    // Fire-and-forget counterpart of submit_bulk()
+    template<class InputIt, class F>
+    void post_bulk(InputIt first, InputIt last, F fn) {
+        using value_type = typename std::iterator_traits<InputIt>::value_type;
+
+        std::vector<Task> batch;
+        for (; first != last; ++first) {
+            batch.emplace_back(BoundTask<F, value_type>(fn, *first));
+        }
+
+        schedule_bulk(batch);
+        notify_work(batch.size());
+    }
+
     // Graceful shutdown
     void shutdown() {
         {
@@ -103,13 +2083,33 @@ public:
             if (is_shutdown) return; // Already stopped
             is_shutdown = true;
         }
-        cv.notify_all(); // Wake everyone up so they can exit
-        
-        for (std::thread &worker : workers) {
-            if (worker.joinable()) {
-                worker.join();
+
+        // No more growth from here on
+        { std::lock_guard<std::mutex> lock(controller_mtx); }
+        controller_cv.notify_all();
+        if (controller.joinable()) {
+            controller.join();
+        }
+        stop_timers();
+
+        wake_all_workers(); // Wake everyone up so they can exit
+
+        std::vector<std::thread> workers;
+        {
+            std::lock_guard<std::mutex> lock(resize_mtx);
+            size_t n = slots_used.load();
+            for (size_t i = 0; i < n; ++i) {
+                if (state_at(i)->thread.joinable()) {
+                    workers.push_back(std::move(state_at(i)->thread));
+                }
             }
         }
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+
+        // Class tasks still parked (rate-limited, their refill timer is gone)
+        drain_parked([this](Task& task) { drop_cancelled(task, "ThreadPool shut down before the task's class let it start"); });
     }
 };
 
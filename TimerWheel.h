@@ -0,0 +1,299 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Identifies one timer. Stays valid for a repeating timer across its
+// firings; a stale handle (timer fired or cancelled) is simply ignored.
+struct TimerHandle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool valid() const {
+        return index != UINT32_MAX;
+    }
+};
+
+// Module 2j: Timer Wheel
+// Hierarchical timing wheel (Varghese & Lauck) over integer ticks: 4 levels
+// of 64 slots, level L holding timers 64^L..64^(L+1) ticks away. Insert and
+// cancel are O(1) (intrusive doubly linked slot lists over a slab, with free
+// list); advancing moves timers one level down when the level below wraps,
+// so each timer is touched at most once per level. Timers further out than
+// the top level sit in its farthest slot and are re-filed as it comes round.
+// Not thread-safe: the owner locks.
+template <typename T>
+class TimerWheel {
+private:
+    static constexpr unsigned kLevelBits = 6;
+    static constexpr unsigned kSlots = 1u << kLevelBits;
+    static constexpr unsigned kLevels = 4;
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    enum class State : uint8_t {
+        Free,
+        Linked,                         // Waiting in a slot
+        Parked,                         // Repeating timer between firing and rearm()
+        Cancelled                       // Cancelled while parked; rearm() frees it
+    };
+
+    struct Node {
+        T item;
+        uint64_t expiry = 0;
+        uint32_t prev = kNone;
+        uint32_t next = kNone;
+        uint32_t generation = 0;
+        uint16_t slot = 0;              // level * kSlots + index
+        State state = State::Free;
+        bool repeating = false;
+    };
+
+    std::vector<Node> nodes;
+    uint32_t free_head = kNone;
+    uint32_t heads[kLevels * kSlots];
+    uint64_t occupied[kLevels] = {};    // Bit per non-empty slot
+    uint64_t current = 0;               // Next tick to process
+    size_t linked = 0;
+
+    uint16_t slot_for(uint64_t expiry) const {
+        if (expiry < current) expiry = current; // Overdue: fire on the next tick
+        uint64_t delta = expiry - current;
+        for (unsigned level = 0; level < kLevels; ++level) {
+            if (delta < (1ull << (kLevelBits * (level + 1)))) {
+                return (uint16_t)(level * kSlots + ((expiry >> (kLevelBits * level)) & (kSlots - 1)));
+            }
+        }
+        // Beyond the top level: park one slot behind the current top-level position
+        unsigned top = kLevels - 1;
+        uint64_t far = current + (1ull << (kLevelBits * kLevels)) - (1ull << (kLevelBits * top));
+        return (uint16_t)(top * kSlots + ((far >> (kLevelBits * top)) & (kSlots - 1)));
+    }
+
+    void link(uint32_t index) {
+        Node& node = nodes[index];
+        node.slot = slot_for(node.expiry);
+        node.prev = kNone;
+        node.next = heads[node.slot];
+        if (node.next != kNone) nodes[node.next].prev = index;
+        heads[node.slot] = index;
+        occupied[node.slot / kSlots] |= 1ull << (node.slot % kSlots);
+        node.state = State::Linked;
+        ++linked;
+    }
+
+    void unlink(uint32_t index) {
+        Node& node = nodes[index];
+        if (node.prev != kNone) {
+            nodes[node.prev].next = node.next;
+        } else {
+            heads[node.slot] = node.next;
+            if (node.next == kNone) occupied[node.slot / kSlots] &= ~(1ull << (node.slot % kSlots));
+        }
+        if (node.next != kNone) nodes[node.next].prev = node.prev;
+        --linked;
+    }
+
+    void release(uint32_t index) {
+        Node& node = nodes[index];
+        node.item = T();
+        node.state = State::Free;
+        ++node.generation;              // Outstanding handles go stale
+        node.next = free_head;
+        free_head = index;
+    }
+
+    uint32_t allocate() {
+        if (free_head == kNone) {
+            nodes.emplace_back();
+            return (uint32_t)(nodes.size() - 1);
+        }
+        uint32_t index = free_head;
+        free_head = nodes[index].next;
+        return index;
+    }
+
+    bool owns(TimerHandle handle) const {
+        return handle.index < nodes.size() && nodes[handle.index].generation == handle.generation;
+    }
+
+    // Detach a whole slot list, returning its first node
+    uint32_t take_slot(uint16_t slot) {
+        uint32_t first = heads[slot];
+        heads[slot] = kNone;
+        occupied[slot / kSlots] &= ~(1ull << (slot % kSlots));
+        return first;
+    }
+
+    // Re-file every timer of a higher-level slot; they land on lower levels
+    void cascade(unsigned level) {
+        uint16_t slot = (uint16_t)(level * kSlots + ((current >> (kLevelBits * level)) & (kSlots - 1)));
+        uint32_t index = take_slot(slot);
+        while (index != kNone) {
+            uint32_t next = nodes[index].next;
+            --linked;
+            link(index);
+            index = next;
+        }
+    }
+
+public:
+    TimerWheel() {
+        for (uint32_t& head : heads) head = kNone;
+    }
+
+    // Start the wheel at 'tick' (timers are never due before it)
+    explicit TimerWheel(uint64_t tick) : TimerWheel() {
+        current = tick;
+    }
+
+    TimerHandle insert(uint64_t expiry, T item, bool repeating = false) {
+        uint32_t index = allocate();
+        Node& node = nodes[index];
+        node.item = std::move(item);
+        node.expiry = expiry;
+        node.repeating = repeating;
+        link(index);
+        return TimerHandle{index, node.generation};
+    }
+
+    // Handle for a repeating timer that is not waiting yet: the item can
+    // carry its own handle, and rearm() files it
+    TimerHandle reserve() {
+        uint32_t index = allocate();
+        Node& node = nodes[index];
+        node.repeating = true;
+        node.state = State::Parked;
+        return TimerHandle{index, node.generation};
+    }
+
+    // Removes a waiting timer and hands back its item (true). A repeating
+    // timer caught between firing and rearm() is marked instead, so rearm()
+    // drops it (also true, with 'item' untouched).
+    bool cancel(TimerHandle handle, T& item) {
+        if (!owns(handle)) return false;
+        Node& node = nodes[handle.index];
+        if (node.state == State::Linked) {
+            unlink(handle.index);
+            item = std::move(node.item);
+            release(handle.index);
+            return true;
+        }
+        if (node.state == State::Parked) {
+            node.state = State::Cancelled;
+            return true;
+        }
+        return false;
+    }
+
+    // Put a fired repeating timer back with a new expiry. False (and the
+    // handle is retired) if it was cancelled in the meantime.
+    bool rearm(TimerHandle handle, uint64_t expiry, T item) {
+        if (!owns(handle)) return false;
+        Node& node = nodes[handle.index];
+        if (node.state == State::Cancelled) {
+            release(handle.index);
+            return false;
+        }
+        if (node.state != State::Parked) return false;
+        node.item = std::move(item);
+        node.expiry = expiry;
+        link(handle.index);
+        return true;
+    }
+
+    // Process every tick up to and including 'tick', calling out(handle, item)
+    // for each timer that comes due, in tick order
+    template <typename Out>
+    void advance(uint64_t tick, Out&& out) {
+        while (current <= tick) {
+            // Jump over empty stretches up to the next level-0 wrap, where cascades happen
+            if (occupied[0] == 0) {
+                uint64_t wrap = (current | (kSlots - 1)) + 1;
+                if ((current & (kSlots - 1)) != 0) {
+                    if (wrap > tick) {
+                        current = tick + 1;
+                        break;
+                    }
+                    current = wrap;
+                }
+            }
+
+            if ((current & (kSlots - 1)) == 0) {
+                for (unsigned level = 1; level < kLevels; ++level) {
+                    cascade(level);
+                    if (((current >> (kLevelBits * level)) & (kSlots - 1)) != 0) break;
+                }
+            }
+
+            uint32_t index = take_slot((uint16_t)(current & (kSlots - 1)));
+            ++current;
+            while (index != kNone) {
+                Node& node = nodes[index];
+                uint32_t next = node.next;
+                --linked;
+                TimerHandle handle{index, node.generation};
+                T item = std::move(node.item);
+                if (node.repeating) {
+                    node.state = State::Parked;
+                } else {
+                    release(index);
+                }
+                out(handle, std::move(item));
+                index = next;
+            }
+        }
+    }
+
+    // Earliest tick at which advance() can have anything to do: the next
+    // busy level-0 slot, or the next level-0 wrap if higher levels hold
+    // timers. UINT64_MAX when nothing is waiting.
+    uint64_t next_tick() const {
+        if (linked == 0) return UINT64_MAX;
+        uint64_t next = UINT64_MAX;
+        for (unsigned level = 1; level < kLevels; ++level) {
+            if (occupied[level] != 0) {
+                next = (current + kSlots - 1) & ~(uint64_t)(kSlots - 1); // Next cascade
+                break;
+            }
+        }
+        unsigned position = (unsigned)(current & (kSlots - 1));
+        uint64_t ahead = occupied[0] >> position;     // Slots from 'current' to the end of this turn
+        if (ahead != 0) {
+            next = std::min(next, current + (uint64_t)__builtin_ctzll(ahead));
+        } else if (occupied[0] != 0) {
+            // Only slots behind 'current': they belong to the next turn
+            next = std::min(next, ((current | (kSlots - 1)) + 1) + (uint64_t)__builtin_ctzll(occupied[0]));
+        }
+        return next;
+    }
+
+    uint64_t now_tick() const {
+        return current;
+    }
+
+    // Waiting timers (parked repeating ones not included)
+    size_t size() const {
+        return linked;
+    }
+
+    // Remove every waiting timer, calling out(item) for each; parked repeating
+    // timers are retired so their rearm() fails
+    template <typename Out>
+    void clear(Out&& out) {
+        for (uint32_t i = 0; i < nodes.size(); ++i) {
+            if (nodes[i].state == State::Linked) {
+                unlink(i);
+                T item = std::move(nodes[i].item);
+                release(i);
+                out(std::move(item));
+            } else if (nodes[i].state == State::Parked) {
+                nodes[i].state = State::Cancelled;
+            }
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef WAKEUP_SIGNAL_H
+#define WAKEUP_SIGNAL_H
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Module 2d: Worker Parking
+// Tell the CPU we are in a spin-wait loop (saves power, frees the sibling hyperthread)
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+// Epoch-based sleep/wake point. A sleeper reads the epoch with prepare(),
+// re-checks its condition, then calls wait(epoch). Any notify() in between
+// bumps the epoch, so wait() returns at once instead of missing the wakeup.
+// On Linux this is a bare futex: no mutex on either side.
+class WakeupSignal {
+private:
+    std::atomic<uint32_t> epoch{0};
+
+#if defined(__linux__)
+    static void futex_wait(std::atomic<uint32_t>* addr, uint32_t expected) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+    }
+
+    static void futex_wake(std::atomic<uint32_t>* addr, int count) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+    }
+#else
+    std::mutex mtx;
+    std::condition_variable cv;
+#endif
+
+public:
+    uint32_t prepare() {
+        return epoch.load(std::memory_order_acquire);
+    }
+
+    // Sleep unless notify() ran since prepare() returned 'seen'. May wake spuriously.
+    void wait(uint32_t seen) {
+#if defined(__linux__)
+        futex_wait(&epoch, seen);
+#else
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this, seen] { return epoch.load(std::memory_order_acquire) != seen; });
+#endif
+    }
+
+    // Like wait(), but gives up after 'timeout'
+    void wait_for(uint32_t seen, std::chrono::milliseconds timeout) {
+#if defined(__linux__)
+        struct timespec ts;
+        ts.tv_sec = (time_t)(timeout.count() / 1000);
+        ts.tv_nsec = (long)(timeout.count() % 1000) * 1000000L;
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch), FUTEX_WAIT_PRIVATE, seen, &ts, nullptr, 0);
+#else
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait_for(lock, timeout, [this, seen] { return epoch.load(std::memory_order_acquire) != seen; });
+#endif
+    }
+
+    void notify(int count) {
+        epoch.fetch_add(1, std::memory_order_release);
+#if defined(__linux__)
+        futex_wake(&epoch, count);
+#else
+        { std::lock_guard<std::mutex> lock(mtx); }
+        if (count == 1) cv.notify_one();
+        else cv.notify_all();
+#endif
+    }
+
+    void notify_all() {
+        notify(INT_MAX);
+    }
+};
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef WORK_STEALING_DEQUE_H
+#define WORK_STEALING_DEQUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Module 2 (work-stealing): Per-Worker Task Deque
+// Chase-Lev deque with the C11 memory orderings from Le, Pop, Cohen & Zappa Nardelli
+// (PPoPP'13). The owning worker pushes and pops at the bottom (LIFO, cache-warm),
+// other workers steal from the top (FIFO, oldest and usually biggest work first).
+// Slots are read racily by thieves, so T must be trivially copyable (store pointers).
+template <typename T>
+class WorkStealingDeque {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "WorkStealingDeque stores raw slots; use a pointer or handle type");
+
+private:
+    struct Array {
+        int64_t capacity;
+        int64_t mask;
+        std::unique_ptr<std::atomic<T>[]> slots;
+
+        explicit Array(int64_t cap) : capacity(cap), mask(cap - 1), slots(new std::atomic<T>[cap]) {}
+
+        void put(int64_t i, T item) { slots[i & mask].store(item, std::memory_order_relaxed); }
+        T get(int64_t i) { return slots[i & mask].load(std::memory_order_relaxed); }
+
+        Array* grow(int64_t bottom, int64_t top) {
+            Array* bigger = new Array(capacity * 2);
+            for (int64_t i = top; i != bottom; ++i) {
+                bigger->put(i, get(i));
+            }
+            return bigger;
+        }
+    };
+
+    alignas(64) std::atomic<int64_t> top;
+    alignas(64) std::atomic<int64_t> bottom;
+    alignas(64) std::atomic<Array*> array;
+
+    // Old arrays may still be read by a thief mid-steal, so they live until the deque dies
+    std::vector<std::unique_ptr<Array>> retired;
+
+public:
+    explicit WorkStealingDeque(int64_t capacity = 1024)
+        : top(0), bottom(0), array(new Array(capacity)) {}
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    ~WorkStealingDeque() {
+        delete array.load(std::memory_order_relaxed);
+    }
+
+    // Owner only
+    void push(T item) {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        Array* a = array.load(std::memory_order_relaxed);
+
+        if (b - t > a->capacity - 1) {
+            Array* bigger = a->grow(b, t);
+            retired.emplace_back(a);
+            array.store(bigger, std::memory_order_release);
+            a = bigger;
+        }
+        a->put(b, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // Owner only: newest item first
+    bool pop(T& item) {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Array* a = array.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed); // Was already empty
+            return false;
+        }
+
+        item = a->get(b);
+        if (t == b) {
+            // Last item: race the thieves for it
+            bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                   std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // Any thread: oldest item first. False means empty or lost a race.
+    bool steal(T& item) {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+
+        if (t >= b) {
+            return false;
+        }
+
+        Array* a = array.load(std::memory_order_acquire);
+        T candidate = a->get(t);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                         std::memory_order_relaxed)) {
+            return false;
+        }
+        item = candidate;
+        return true;
+    }
+
+    size_t size() {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_relaxed);
+        return b > t ? (size_t)(b - t) : 0;
+    }
+
+    bool empty() {
+        return size() == 0;
+    }
+};
+
+#endif
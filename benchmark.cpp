@@ -0,0 +1,1153 @@
+// Benchmark suite for the thread library
+// Build: g++ -std=c++17 -O2 -pthread benchmark.cpp -o benchmark
+// Run:   ./benchmark [suite]      (no argument runs every suite)
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+#include <new>
+#include <numeric>
+#include <random>
+#include "ThreadPool.h"
+#include "TaskGroup.h"
+#include "ParallelAlgorithms.h"
+#include "TaskGraph.h"
+#include "Future.h"
+#include "Coroutine.h"
+#include "Executor.h"
+#include "AsyncIo.h"
+
+using Clock = std::chrono::steady_clock;
+
+// Every heap allocation in the process goes through here so suites can count them
+static std::atomic<long> g_allocations{0};
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete" // GCC can't see that operator new above is malloc
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+#pragma GCC diagnostic pop
+
+static double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// =========================================
+// SUITE: queue
+// Producer/consumer throughput of SafeQueue vs LockFreeQueue, 1..64 threads per side
+// =========================================
+template <typename Queue>
+static double queue_throughput(Queue& queue, int pairs, int items_per_producer) {
+    std::atomic<int> consumed{0};
+    const int total = pairs * items_per_producer;
+    std::vector<std::thread> threads;
+
+    auto start = Clock::now();
+    for (int p = 0; p < pairs; ++p) {
+        threads.emplace_back([&queue, items_per_producer] {
+            for (int i = 0; i < items_per_producer; ++i) {
+                queue.push([] {});
+            }
+        });
+    }
+    for (int c = 0; c < pairs; ++c) {
+        threads.emplace_back([&queue, &consumed, total] {
+            std::function<void()> item;
+            while (consumed.load(std::memory_order_relaxed) < total) {
+                if (queue.pop(item)) {
+                    consumed.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    return total / seconds_since(start) / 1e6;
+}
+
+static void bench_queue() {
+    const int total_items = 400000;
+    std::cout << "\n[queue] push/pop throughput, " << total_items << " items (Mops/s)\n";
+    std::cout << std::setw(10) << "threads" << std::setw(12) << "SafeQueue"
+              << std::setw(14) << "LockFree" << std::setw(10) << "ratio" << "\n";
+
+    for (int pairs = 1; pairs <= 64; pairs *= 2) {
+        SafeQueue<std::function<void()>> locked;
+        LockFreeQueue<std::function<void()>> ring(16384);
+
+        double a = queue_throughput(locked, pairs, total_items / pairs);
+        double b = queue_throughput(ring, pairs, total_items / pairs);
+
+        std::cout << std::setw(6) << pairs << "x" << pairs << "  "
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(10) << a << std::setw(14) << b
+                  << std::setw(9) << b / a << "x\n";
+    }
+
+    // Nested fan-out into a ring far smaller than the burst: workers are the
+    // only consumers, so the pool must not wait on them for space
+    PoolOptions options;
+    options.queue_kind = QueueKind::LockFree;
+    options.queue_capacity = 8;
+    for (size_t workers : {1, 4}) {
+        ThreadPool pool(workers, options);
+        std::atomic<int> done{0};
+        auto start = Clock::now();
+        for (int p = 0; p < 10; ++p) {
+            pool.post([&pool, &done] {
+                for (int i = 0; i < 1000; ++i) pool.post([&done] { done.fetch_add(1); });
+            });
+        }
+        while (done.load() < 10 * 1000) std::this_thread::yield();
+        std::cout << "  nested fan-out, " << workers << " worker(s), ring of 8: " << done.load()
+                  << " tasks in " << std::fixed << std::setprecision(2) << seconds_since(start) * 1e3 << " ms\n";
+    }
+}
+
+// =========================================
+// SUITE: steal
+// Recursive fan-out (tasks spawning tasks): global queue vs work-stealing
+// =========================================
+static void spawn_tree(ThreadPool& pool, std::atomic<long>& done, int depth) {
+    if (depth > 0) {
+        for (int i = 0; i < 2; ++i) {
+            pool.submit([&pool, &done, depth] { spawn_tree(pool, done, depth - 1); });
+        }
+    }
+    done.fetch_add(1, std::memory_order_relaxed);
+}
+
+static double fan_out_throughput(SchedulingMode mode, size_t threads, int depth) {
+    PoolOptions options;
+    options.mode = mode;
+    ThreadPool pool(threads, options);
+
+    std::atomic<long> done{0};
+    const long total = (1L << (depth + 1)) - 1;
+
+    auto start = Clock::now();
+    pool.submit([&pool, &done, depth] { spawn_tree(pool, done, depth); });
+    while (done.load(std::memory_order_relaxed) < total) {
+        std::this_thread::yield();
+    }
+    return total / seconds_since(start) / 1e6;
+}
+
+static void bench_steal() {
+    const int depth = 17;
+    std::cout << "\n[steal] binary task tree of depth " << depth << " (Mtasks/s)\n";
+    std::cout << std::setw(10) << "workers" << std::setw(14) << "GlobalQueue"
+              << std::setw(14) << "WorkStealing" << "\n";
+
+    for (size_t threads = 1; threads <= 64; threads *= 2) {
+        double a = fan_out_throughput(SchedulingMode::GlobalQueue, threads, depth);
+        double b = fan_out_throughput(SchedulingMode::WorkStealing, threads, depth);
+        std::cout << std::setw(10) << threads << std::fixed << std::setprecision(2)
+                  << std::setw(14) << a << std::setw(14) << b << "\n";
+    }
+}
+
+// =========================================
+// SUITE: latency
+// Submit-to-start time: sparse submits into an idle pool, then a back-to-back burst
+// =========================================
+static void print_percentiles(const char* label, std::vector<double>& us) {
+    std::sort(us.begin(), us.end());
+    auto at = [&us](double q) { return us[(size_t)(q * (us.size() - 1))]; };
+    std::cout << std::setw(16) << label << std::fixed << std::setprecision(1)
+              << std::setw(10) << at(0.50) << std::setw(10) << at(0.90)
+              << std::setw(10) << at(0.99) << std::setw(12) << us.back() << "\n";
+}
+
+static void measure_latency(IdleStrategy strategy, const std::string& name, int samples) {
+    PoolOptions options;
+    options.idle_strategy = strategy;
+    ThreadPool pool(4, options);
+    std::vector<double> sparse(samples), burst(samples);
+    std::atomic<int> started{0};
+
+    for (int i = 0; i < samples; ++i) {
+        auto submitted = Clock::now();
+        pool.submit([&sparse, &started, submitted, i] {
+            sparse[i] = std::chrono::duration<double, std::micro>(Clock::now() - submitted).count();
+            started.fetch_add(1, std::memory_order_release);
+        });
+        while (started.load(std::memory_order_acquire) <= i) std::this_thread::yield();
+        std::this_thread::sleep_for(std::chrono::microseconds(50)); // Let the workers park again
+    }
+
+    started = 0;
+    for (int i = 0; i < samples; ++i) {
+        auto submitted = Clock::now();
+        pool.submit([&burst, &started, submitted, i] {
+            burst[i] = std::chrono::duration<double, std::micro>(Clock::now() - submitted).count();
+            started.fetch_add(1, std::memory_order_release);
+        });
+    }
+    while (started.load(std::memory_order_acquire) < samples) std::this_thread::yield();
+
+    print_percentiles(("sparse/" + name).c_str(), sparse);
+    print_percentiles(("burst/" + name).c_str(), burst);
+}
+
+static void bench_latency() {
+    const int samples = 2000;
+    std::cout << "\n[latency] submit-to-start, 4 workers, " << samples << " tasks (us)\n";
+    std::cout << std::setw(16) << "pattern" << std::setw(10) << "p50" << std::setw(10) << "p90"
+              << std::setw(10) << "p99" << std::setw(12) << "max" << "\n";
+    measure_latency(IdleStrategy::Block, "block", samples);
+    measure_latency(IdleStrategy::SpinThenPark, "spin", samples);
+}
+
+// =========================================
+// SUITE: alloc
+// Heap allocations and cost per packaged task: the old
+// make_shared<packaged_task> + bind + std::function path vs Task + PromiseTask
+// =========================================
+static int add_one(int x) { return x + 1; }
+
+static void bench_alloc() {
+    const int tasks = 200000;
+    std::vector<std::future<int>> futures;
+    futures.reserve(tasks);
+
+    std::cout << "\n[alloc] building, queueing and running " << tasks << " tasks\n";
+    std::cout << std::setw(28) << "path" << std::setw(14) << "allocs/task" << std::setw(12) << "Mtasks/s" << "\n";
+
+    {
+        SafeQueue<std::function<void()>> queue;
+        long before = g_allocations.load();
+        auto start = Clock::now();
+        for (int i = 0; i < tasks; ++i) {
+            auto task = std::make_shared<std::packaged_task<int()>>(std::bind(add_one, i));
+            futures.push_back(task->get_future());
+            queue.push([task]() { (*task)(); });
+        }
+        std::function<void()> item;
+        while (queue.pop(item)) item();
+        double secs = seconds_since(start);
+        std::cout << std::setw(28) << "packaged_task+std::function" << std::fixed << std::setprecision(2)
+                  << std::setw(14) << (double)(g_allocations.load() - before) / tasks
+                  << std::setw(12) << tasks / secs / 1e6 << "\n";
+    }
+
+    futures.clear();
+    {
+        SafeQueue<Task> queue;
+        long before = g_allocations.load();
+        auto start = Clock::now();
+        for (int i = 0; i < tasks; ++i) {
+            std::promise<int> promise;
+            futures.push_back(promise.get_future());
+            queue.push(PromiseTask<int, int (*)(int), int>(std::move(promise), add_one, i));
+        }
+        Task item;
+        while (queue.pop(item)) item();
+        double secs = seconds_since(start);
+        std::cout << std::setw(28) << "Task+PromiseTask" << std::fixed << std::setprecision(2)
+                  << std::setw(14) << (double)(g_allocations.load() - before) / tasks
+                  << std::setw(12) << tasks / secs / 1e6 << "\n";
+    }
+}
+
+// =========================================
+// SUITE: post
+// Pool throughput when the caller throws the result away: submit() vs post()
+// =========================================
+static void bench_post() {
+    const int tasks = 200000;
+    std::cout << "\n[post] " << tasks << " empty tasks on 4 workers\n";
+    std::cout << std::setw(10) << "api" << std::setw(14) << "allocs/task" << std::setw(12) << "Mtasks/s" << "\n";
+
+    for (int use_post = 0; use_post < 2; ++use_post) {
+        ThreadPool pool(4);
+        std::atomic<int> done{0};
+        auto body = [&done] { done.fetch_add(1, std::memory_order_relaxed); };
+
+        long before = g_allocations.load();
+        auto start = Clock::now();
+        for (int i = 0; i < tasks; ++i) {
+            if (use_post) pool.post(body);
+            else pool.submit(body);
+        }
+        while (done.load(std::memory_order_relaxed) < tasks) std::this_thread::yield();
+        double secs = seconds_since(start);
+
+        std::cout << std::setw(10) << (use_post ? "post" : "submit") << std::fixed << std::setprecision(2)
+                  << std::setw(14) << (double)(g_allocations.load() - before) / tasks
+                  << std::setw(12) << tasks / secs / 1e6 << "\n";
+    }
+}
+
+// =========================================
+// SUITE: bulk
+// Absorbing 1000-task bursts like /inject: post() in a loop vs post_bulk()
+// =========================================
+static void bench_bulk() {
+    const int bursts = 200, burst_size = 1000;
+    std::vector<int> ids(burst_size, 0);
+    std::cout << "\n[bulk] " << bursts << " bursts of " << burst_size << " tasks on 4 workers\n";
+    std::cout << std::setw(10) << "api" << std::setw(18) << "enqueue us/burst" << std::setw(12) << "Mtasks/s" << "\n";
+
+    for (int bulk = 0; bulk < 2; ++bulk) {
+        ThreadPool pool(4);
+        std::atomic<int> done{0};
+        auto body = [&done](int) { done.fetch_add(1, std::memory_order_relaxed); };
+
+        double enqueue_us = 0;
+        auto start = Clock::now();
+        for (int b = 0; b < bursts; ++b) {
+            auto burst_start = Clock::now();
+            if (bulk) {
+                pool.post_bulk(ids.begin(), ids.end(), body);
+            } else {
+                for (int id : ids) pool.post(body, id);
+            }
+            enqueue_us += seconds_since(burst_start) * 1e6;
+        }
+        while (done.load(std::memory_order_relaxed) < bursts * burst_size) std::this_thread::yield();
+        double secs = seconds_since(start);
+
+        std::cout << std::setw(10) << (bulk ? "post_bulk" : "post") << std::fixed << std::setprecision(1)
+                  << std::setw(18) << enqueue_us / bursts << std::setprecision(2)
+                  << std::setw(12) << bursts * burst_size / secs / 1e6 << "\n";
+    }
+}
+
+// =========================================
+// SUITE: batch
+// Draining a pre-filled backlog of tiny tasks with different dequeue_batch limits
+// =========================================
+static void bench_batch() {
+    const int tasks = 500000;
+    std::vector<int> ids(tasks, 0);
+    std::cout << "\n[batch] drain " << tasks << " queued tasks, 4 workers\n";
+    std::cout << std::setw(14) << "dequeue_batch" << std::setw(12) << "Mtasks/s" << "\n";
+
+    for (size_t limit : {1, 4, 16, 64}) {
+        PoolOptions options;
+        options.dequeue_batch = limit;
+        ThreadPool pool(4, options);
+        std::atomic<int> done{0};
+
+        auto start = Clock::now();
+        pool.post_bulk(ids.begin(), ids.end(), [&done](int) { done.fetch_add(1, std::memory_order_relaxed); });
+        while (done.load(std::memory_order_relaxed) < tasks) std::this_thread::yield();
+        double secs = seconds_since(start);
+
+        std::cout << std::setw(14) << limit << std::fixed << std::setprecision(2)
+                  << std::setw(12) << tasks / secs / 1e6 << "\n";
+    }
+}
+
+// =========================================
+// SUITE: numa
+// Memory-bound tasks whose buffer was first touched on one NUMA node (one
+// pinned producer per node). "remote" counts tasks that ran on another node.
+// =========================================
+static void bench_numa() {
+    const int tasks_per_node = 4000;
+    const size_t buffer_words = 16384;  // 128 KB per task
+    CpuTopology topology = CpuTopology::detect();
+    size_t nodes = topology.node_count();
+    size_t threads = topology.cpus().size();
+
+    std::cout << "\n[numa] " << nodes << " node(s), " << threads << " CPU(s), "
+              << tasks_per_node << " tasks per node summing 128 KB each\n";
+    if (nodes == 1) std::cout << "(single node: every access is local, placements only differ by pinning)\n";
+    std::cout << std::setw(14) << "placement" << std::setw(12) << "Mtasks/s" << std::setw(10) << "remote" << "\n";
+
+    std::pair<Placement, const char*> placements[] = {
+        {Placement::None, "none"}, {Placement::Compact, "compact"},
+        {Placement::Scatter, "scatter"}, {Placement::PerNumaNode, "per-node"}};
+
+    for (auto& entry : placements) {
+        PoolOptions options;
+        options.placement = entry.first;
+        ThreadPool pool(threads, options);
+        std::atomic<long> remote{0};
+        std::atomic<int> done{0};
+        const int total = tasks_per_node * (int)nodes;
+
+        // Each producer allocates (first touch) on its own node before the clock starts
+        std::vector<std::vector<std::vector<long>>> buffers(nodes);
+        std::vector<std::thread> producers;
+        for (size_t node = 0; node < nodes; ++node) {
+            producers.emplace_back([&, node] {
+                pin_current_thread(topology.node_cpus(node));
+                for (int i = 0; i < 64; ++i) buffers[node].emplace_back(buffer_words, i);
+            });
+        }
+        for (auto& t : producers) t.join();
+        producers.clear();
+
+        auto start = Clock::now();
+        for (size_t node = 0; node < nodes; ++node) {
+            producers.emplace_back([&, node] {
+                pin_current_thread(topology.node_cpus(node));
+                for (int i = 0; i < tasks_per_node; ++i) {
+                    const std::vector<long>* data = &buffers[node][i % buffers[node].size()];
+                    pool.post([&, data, node] {
+                        long sum = 0;
+                        for (long v : *data) sum += v;
+                        if (topology.node_of(current_cpu()) != node) remote.fetch_add(1, std::memory_order_relaxed);
+                        if (sum >= 0) done.fetch_add(1, std::memory_order_relaxed);
+                    });
+                }
+            });
+        }
+        for (auto& t : producers) t.join();
+        while (done.load(std::memory_order_relaxed) < total) std::this_thread::yield();
+        double secs = seconds_since(start);
+
+        std::cout << std::setw(14) << entry.second << std::fixed << std::setprecision(2)
+                  << std::setw(12) << total / secs / 1e6
+                  << std::setw(9) << std::setprecision(1) << 100.0 * remote / total << "%\n";
+    }
+}
+
+// =========================================
+// SUITE: priority
+// A 20000-task bulk backlog (50 us each) plus an interactive request every
+// millisecond: submit() queues it behind the backlog, Critical jumps it
+// =========================================
+static void spin_for(std::chrono::microseconds d) {
+    auto until = Clock::now() + d;
+    while (Clock::now() < until) {}
+}
+
+static void bench_priority() {
+    const int bulk = 20000;
+    const int interactive = 200;
+    std::cout << "\n[priority] submit-to-start of " << interactive << " interactive tasks over a "
+              << bulk << "-task bulk backlog, 4 workers (us)\n";
+    std::cout << std::setw(16) << "interactive" << std::setw(10) << "p50" << std::setw(10) << "p90"
+              << std::setw(10) << "p99" << std::setw(12) << "max" << "\n";
+
+    for (bool prioritized : {false, true}) {
+        ThreadPool pool(4);
+        for (int i = 0; i < bulk; ++i) {
+            if (prioritized) pool.submit_with_priority(Priority::Low, spin_for, std::chrono::microseconds(50));
+            else pool.post(spin_for, std::chrono::microseconds(50));
+        }
+
+        std::vector<double> waits(interactive);
+        std::vector<std::future<void>> done;
+        for (int i = 0; i < interactive; ++i) {
+            auto submitted = Clock::now();
+            auto record = [&waits, submitted, i] {
+                waits[i] = std::chrono::duration<double, std::micro>(Clock::now() - submitted).count();
+            };
+            done.push_back(prioritized ? pool.submit_with_priority(Priority::Critical, record) : pool.submit(record));
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        for (auto& f : done) f.get();
+        print_percentiles(prioritized ? "Critical lane" : "submit()", waits);
+
+        if (prioritized) {
+            pool.shutdown();
+            LaneStats low = pool.get_lane_stats(Priority::Low);
+            std::cout << std::setw(16) << "Low lane" << std::fixed << std::setprecision(1)
+                      << std::setw(10) << low.p50_us << std::setw(10) << low.p90_us << std::setw(10) << low.p99_us
+                      << "   (" << low.started << " bulk tasks, " << low.promoted << " aged up)\n";
+        }
+    }
+
+    // Long backlog: after many aging periods the Low tasks have climbed as far
+    // as they can, and new Critical work must still go straight past them
+    ThreadPool pool(4);
+    for (int i = 0; i < 4000; ++i) {
+        pool.submit_with_priority(Priority::Low, spin_for, std::chrono::microseconds(2000));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+    std::vector<double> waits(20);
+    for (size_t i = 0; i < waits.size(); ++i) {
+        auto submitted = Clock::now();
+        pool.submit_with_priority(Priority::Critical, [&waits, submitted, i] {
+            waits[i] = std::chrono::duration<double, std::micro>(Clock::now() - submitted).count();
+        }).get();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    pool.cancel_all();
+    print_percentiles("Critical, aged", waits);
+}
+
+// =========================================
+// SUITE: deadline
+// 2x overload of 200 us tasks that are worthless 5 ms after submission:
+// goodput (tasks finished in time) with plain submit() vs submit_with_deadline()
+// =========================================
+static void bench_deadline() {
+    const auto work = std::chrono::microseconds(200);
+    const auto budget = std::chrono::milliseconds(5);
+    const auto duration = std::chrono::milliseconds(500);
+    const size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    const int per_ms = (int)(2 * threads * 1000 / work.count()); // Twice what the workers can do in 1 ms
+
+    std::cout << "\n[deadline] " << threads << " workers, " << per_ms << " tasks/ms of "
+              << work.count() << " us, deadline " << budget.count() << " ms\n";
+    std::cout << std::setw(16) << "submission" << std::setw(12) << "in time" << std::setw(10) << "late"
+              << std::setw(10) << "shed" << std::setw(14) << "goodput/s" << "\n";
+
+    for (bool with_deadline : {false, true}) {
+        ThreadPool pool(threads);
+        std::atomic<long> in_time{0}, late{0};
+
+        auto start = Clock::now();
+        while (Clock::now() - start < duration) {
+            for (int i = 0; i < per_ms; ++i) {
+                auto deadline = Clock::now() + budget;
+                auto task = [&in_time, &late, work, deadline] {
+                    spin_for(work);
+                    (Clock::now() <= deadline ? in_time : late).fetch_add(1, std::memory_order_relaxed);
+                };
+                if (with_deadline) pool.post_with_deadline(deadline, [] {}, task);
+                else pool.post(task);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        pool.shutdown();
+        double secs = seconds_since(start);
+
+        std::cout << std::setw(16) << (with_deadline ? "with_deadline" : "post()")
+                  << std::setw(12) << in_time << std::setw(10) << late
+                  << std::setw(10) << pool.get_deadline_stats().shed
+                  << std::setw(14) << std::fixed << std::setprecision(0) << in_time / secs << "\n";
+    }
+}
+
+// =========================================
+// SUITE: group
+// Recursive fib with TaskGroup fork/join (a waiting thread runs the group's
+// queued tasks instead of blocking; with future.get() a pool this small would deadlock)
+// =========================================
+static long fib_serial(int n) {
+    return n < 2 ? n : fib_serial(n - 1) + fib_serial(n - 2);
+}
+
+static long fib_group(ThreadPool& pool, int n, int cutoff) {
+    if (n < cutoff) return fib_serial(n);
+    long x = 0, y = 0;
+    TaskGroup group(pool);
+    group.run([&] { x = fib_group(pool, n - 1, cutoff); });
+    group.run([&] { y = fib_group(pool, n - 2, cutoff); });
+    group.wait();
+    return x + y;
+}
+
+static void bench_group() {
+    const int n = 32;
+    std::cout << "\n[group] fib(" << n << ") with TaskGroup, 4 workers (ms)\n";
+    std::cout << std::setw(10) << "cutoff" << std::setw(14) << "GlobalQueue" << std::setw(14) << "WorkStealing" << "\n";
+
+    auto start = Clock::now();
+    long expected = fib_serial(n);
+    std::cout << std::setw(10) << "serial" << std::fixed << std::setprecision(1)
+              << std::setw(14) << seconds_since(start) * 1e3 << "\n";
+
+    for (int cutoff : {24, 18, 12}) {
+        std::cout << std::setw(10) << cutoff;
+        for (SchedulingMode mode : {SchedulingMode::GlobalQueue, SchedulingMode::WorkStealing}) {
+            PoolOptions options;
+            options.mode = mode;
+            ThreadPool pool(4, options);
+            start = Clock::now();
+            long result = pool.submit(fib_group, std::ref(pool), n, cutoff).get();
+            double ms = seconds_since(start) * 1e3;
+            std::cout << std::setw(14) << (result == expected ? ms : -1.0);
+        }
+        std::cout << "\n";
+    }
+}
+
+// =========================================
+// SUITE: parfor
+// One million cheap elements: submit() per element (the main.cpp pattern),
+// post() per element, parallel_for, and a parallel_reduce sum
+// =========================================
+static void bench_parfor() {
+    const int n = 1000000;
+    std::vector<double> out(n);
+    std::cout << "\n[parfor] " << n << " elements of sqrt(), 4 workers (ms)\n";
+
+    auto report = [](const char* label, double secs) {
+        std::cout << std::setw(22) << label << std::fixed << std::setprecision(1) << std::setw(10) << secs * 1e3 << "\n";
+    };
+
+    auto start = Clock::now();
+    for (int i = 0; i < n; ++i) out[i] = std::sqrt((double)i);
+    report("serial", seconds_since(start));
+
+    {
+        ThreadPool pool(4);
+        start = Clock::now();
+        std::vector<std::future<void>> futures;
+        futures.reserve(n);
+        for (int i = 0; i < n; ++i) futures.push_back(pool.submit([&out, i] { out[i] = std::sqrt((double)i); }));
+        for (auto& f : futures) f.get();
+        report("submit per element", seconds_since(start));
+    }
+    {
+        ThreadPool pool(4);
+        std::atomic<int> done{0};
+        start = Clock::now();
+        for (int i = 0; i < n; ++i) {
+            pool.post([&out, &done, i] { out[i] = std::sqrt((double)i); done.fetch_add(1, std::memory_order_relaxed); });
+        }
+        while (done.load(std::memory_order_relaxed) < n) std::this_thread::yield();
+        report("post per element", seconds_since(start));
+    }
+    for (SchedulingMode mode : {SchedulingMode::GlobalQueue, SchedulingMode::WorkStealing}) {
+        PoolOptions options;
+        options.mode = mode;
+        ThreadPool pool(4, options);
+        start = Clock::now();
+        parallel_for(pool, 0, n, [&out](int i) { out[i] = std::sqrt((double)i); });
+        report(mode == SchedulingMode::GlobalQueue ? "parallel_for/global" : "parallel_for/steal", seconds_since(start));
+
+        start = Clock::now();
+        double sum = parallel_reduce(pool, 0, n, 0.0,
+            [&out](int lo, int hi, double acc) { for (int i = lo; i < hi; ++i) acc += out[i]; return acc; },
+            [](double a, double b) { return a + b; });
+        report(mode == SchedulingMode::GlobalQueue ? "parallel_reduce/global" : "parallel_reduce/steal", seconds_since(start));
+        if (sum <= 0) std::cout << "bad sum\n";
+    }
+}
+
+// =========================================
+// SUITE: graph
+// A layered DAG (8 layers x 32 nodes, each node needs 3 nodes of the layer
+// before it): tasks that block on their predecessors' futures vs TaskGraph
+// =========================================
+static void bench_graph() {
+    const int layers = 8, width = 32, fan_in = 3;
+    const auto work = std::chrono::microseconds(50);
+    std::cout << "\n[graph] " << layers << "x" << width << " DAG, 50us nodes, 4 workers (ms)\n";
+
+    auto preds = [&](int layer, int w) {
+        std::vector<int> p;
+        for (int k = 0; k < fan_in; ++k) p.push_back((layer - 1) * width + (w + k * 7) % width);
+        return p;
+    };
+    auto report = [](const char* label, double secs) {
+        std::cout << std::setw(22) << label << std::fixed << std::setprecision(2) << std::setw(10) << secs * 1e3 << "\n";
+    };
+
+    ThreadPool pool(4);
+    {
+        auto start = Clock::now();
+        std::vector<std::shared_future<void>> futures;
+        for (int layer = 0; layer < layers; ++layer) {
+            for (int w = 0; w < width; ++w) {
+                std::vector<std::shared_future<void>> before;
+                if (layer > 0) for (int p : preds(layer, w)) before.push_back(futures[p]);
+                futures.push_back(pool.submit([before, work] {
+                    for (auto& f : before) f.get();   // A worker sits here doing nothing
+                    spin_for(work);
+                }).share());
+            }
+        }
+        for (auto& f : futures) f.get();
+        report("blocking futures", seconds_since(start));
+    }
+
+    TaskGraph graph;
+    for (int layer = 0; layer < layers; ++layer) {
+        for (int w = 0; w < width; ++w) {
+            size_t id = graph.add([work] { spin_for(work); });
+            if (layer > 0) for (int p : preds(layer, w)) graph.precede((size_t)p, id);
+        }
+    }
+
+    auto start = Clock::now();
+    graph.run(pool);
+    report("TaskGraph first run", seconds_since(start));
+
+    const int runs = 20;
+    start = Clock::now();
+    for (int r = 0; r < runs; ++r) graph.run(pool);
+    report("TaskGraph reused", seconds_since(start) / runs);
+
+    CriticalPath path = graph.critical_path();
+    std::cout << "  critical path " << path.nodes.size() << " nodes, "
+              << std::setprecision(2) << path.length.count() / 1e6 << " ms of "
+              << path.total_work.count() / 1e6 << " ms total work\n";
+}
+
+// =========================================
+// SUITE: then
+// A chain of 10^6 "x + 1" steps: submit().get() per step from the caller
+// (the blocking pattern) vs PoolFuture::then, posted and inline
+// =========================================
+static void bench_then() {
+    const long n = 1000000;
+    std::cout << "\n[then] chain of " << n << " steps, 4 workers\n";
+    std::cout << std::setw(22) << "pattern" << std::setw(12) << "total ms" << std::setw(12) << "ns/step" << "\n";
+
+    auto report = [n](const char* label, double secs, bool correct) {
+        std::cout << std::setw(22) << label << std::fixed << std::setprecision(1)
+                  << std::setw(12) << (correct ? secs * 1e3 : -1.0) << std::setw(12) << secs * 1e9 / n << "\n";
+    };
+
+    ThreadPool pool(4);
+    {
+        auto start = Clock::now();
+        long x = 0;
+        for (long i = 0; i < n; ++i) x = pool.submit([x] { return x + 1; }).get();
+        report("blocking get()", seconds_since(start), x == n);
+    }
+
+    for (Launch launch : {Launch::Post, Launch::Inline}) {
+        auto start = Clock::now();
+        PoolPromise<long> first(&pool);
+        PoolFuture<long> chain = first.get_future();
+        for (long i = 0; i < n; ++i) chain = chain.then([](long x) { return x + 1; }, launch);
+        first.set_value(0);   // Whole chain attached up front, then released at once
+        long x = chain.get();
+        report(launch == Launch::Post ? "then (Post)" : "then (Inline)", seconds_since(start), x == n);
+    }
+}
+
+// =========================================
+// SUITE: coro (C++20 builds only)
+// 50,000 operations in flight at once, each waiting for a result that
+// arrives later: coroutines suspended on a PoolFuture vs a thread per
+// operation blocked on std::future (only 1,000 of those)
+// =========================================
+#ifdef THREAD_POOL_COROUTINES
+static CoTask<void> await_result(ThreadPool& pool, PoolFuture<int> result, std::atomic<long>& sum, std::atomic<int>& left) {
+    co_await pool.schedule();
+    sum.fetch_add(co_await std::move(result), std::memory_order_relaxed);
+    left.fetch_sub(1, std::memory_order_relaxed);
+}
+
+static void bench_coro() {
+    std::cout << "\n[coro] in-flight operations waiting on a late result, 4 workers\n";
+    std::cout << std::setw(22) << "pattern" << std::setw(10) << "ops" << std::setw(12) << "total ms" << std::setw(12) << "us/op" << "\n";
+
+    auto report = [](const char* label, int ops, double secs) {
+        std::cout << std::setw(22) << label << std::setw(10) << ops << std::fixed << std::setprecision(1)
+                  << std::setw(12) << secs * 1e3 << std::setprecision(2) << std::setw(12) << secs * 1e6 / ops << "\n";
+    };
+
+    {
+        const int ops = 50000;
+        ThreadPool pool(4);
+        std::vector<PoolPromise<int>> results;
+        results.reserve(ops);
+        std::atomic<long> sum{0};
+        std::atomic<int> left{ops};
+
+        auto start = Clock::now();
+        for (int i = 0; i < ops; ++i) {
+            results.emplace_back(&pool);
+            spawn(pool, await_result(pool, results.back().get_future(), sum, left));
+        }
+        for (int i = 0; i < ops; ++i) results[i].set_value(1);
+        while (left.load(std::memory_order_relaxed) > 0) std::this_thread::yield();
+        report(sum == ops ? "coroutines" : "coroutines (wrong)", ops, seconds_since(start));
+    }
+    {
+        const int ops = 1000;
+        std::vector<std::promise<int>> results(ops);
+        std::vector<std::thread> threads;
+        std::atomic<long> sum{0};
+
+        auto start = Clock::now();
+        for (int i = 0; i < ops; ++i) {
+            threads.emplace_back([&sum, f = results[i].get_future()]() mutable { sum += f.get(); });
+        }
+        for (auto& r : results) r.set_value(1);
+        for (auto& t : threads) t.join();
+        report(sum == ops ? "thread per op" : "thread per op (wrong)", ops, seconds_since(start));
+    }
+}
+#endif
+
+// =========================================
+// SUITE: blocking
+// 200 "I/O" tasks (20ms sleep) mixed with 400 CPU tasks (500us spin), with
+// 4 CPU workers: all on one pool, one pool with blocking_region() around
+// the sleep, and Executor with the sleeps on submit_blocking()
+// =========================================
+static void bench_blocking() {
+    const int io_tasks = 200, cpu_tasks = 400;
+    const auto io_wait = std::chrono::milliseconds(20);
+    const auto cpu_work = std::chrono::microseconds(500);
+    std::cout << "\n[blocking] " << io_tasks << " x 20ms I/O + " << cpu_tasks << " x 500us CPU, 4 CPU workers (ms)\n";
+    std::cout << std::setw(22) << "setup" << std::setw(12) << "CPU done" << std::setw(12) << "all done" << std::setw(10) << "threads" << "\n";
+
+    for (int setup = 0; setup < 3; ++setup) {
+        ExecutorOptions options;
+        options.cpu_threads = 4;
+        Executor exec(options);
+        ThreadPool& cpu = exec.cpu_pool();
+        std::atomic<int> cpu_left{cpu_tasks}, io_left{io_tasks};
+        std::atomic<size_t> peak_threads{0};
+
+        auto record_threads = [&] {
+            size_t now = exec.get_workers_count(), seen = peak_threads.load();
+            while (now > seen && !peak_threads.compare_exchange_weak(seen, now)) {}
+        };
+        auto io = [&] {
+            if (setup == 1) {
+                auto region = cpu.blocking_region();
+                record_threads();
+                std::this_thread::sleep_for(io_wait);
+            } else {
+                record_threads();
+                std::this_thread::sleep_for(io_wait);
+            }
+            io_left.fetch_sub(1);
+        };
+
+        auto start = Clock::now();
+        for (int i = 0; i < io_tasks; ++i) {
+            if (setup == 2) exec.post_blocking(io);
+            else cpu.post(io);
+        }
+        for (int i = 0; i < cpu_tasks; ++i) cpu.post([&] { spin_for(cpu_work); cpu_left.fetch_sub(1); });
+
+        double cpu_done = 0;
+        while (io_left.load() > 0 || cpu_left.load() > 0) {
+            if (cpu_done == 0 && cpu_left.load() == 0) cpu_done = seconds_since(start);
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        if (cpu_done == 0) cpu_done = seconds_since(start);
+        double all_done = seconds_since(start);
+
+        const char* label = setup == 0 ? "one pool" : setup == 1 ? "blocking_region()" : "submit_blocking()";
+        std::cout << std::setw(22) << label << std::fixed << std::setprecision(1)
+                  << std::setw(12) << cpu_done * 1e3 << std::setw(12) << all_done * 1e3
+                  << std::setw(10) << peak_threads.load() << "\n";
+    }
+}
+
+// =========================================
+// SUITE: tenants
+// One client floods 4 workers with 20000 x 100us tasks while another submits
+// a 100us task every 2ms: its queue wait with everything untagged in the one
+// FIFO queue, with each client in its own tenant, and with only the flood
+// tagged (the light client's plain posts then go to the "default" tenant)
+// =========================================
+static void bench_tenants() {
+    const int flood = 20000, light_tasks = 200;
+    std::cout << "\n[tenants] light client's wait behind a " << flood << " x 100us flood, 4 workers (us)\n";
+    std::cout << std::setw(16) << "setup" << std::setw(10) << "p50" << std::setw(10) << "p90"
+              << std::setw(10) << "p99" << std::setw(12) << "max" << "\n";
+
+    for (int setup = 0; setup < 3; ++setup) {
+        ThreadPool pool(4);
+        Tenant spammer, light;
+        if (setup >= 1) spammer = pool.tenant("spammer");
+        if (setup == 1) light = pool.tenant("light");
+        std::atomic<int> started{0};
+        std::vector<double> wait_us(light_tasks);
+
+        for (int i = 0; i < flood; ++i) {
+            auto task = [] { spin_for(std::chrono::microseconds(100)); };
+            if (setup == 0) pool.post(task);
+            else pool.post(spammer, task);
+        }
+        for (int i = 0; i < light_tasks; ++i) {
+            auto submitted = Clock::now();
+            auto task = [&wait_us, &started, submitted, i] {
+                wait_us[i] = std::chrono::duration<double, std::micro>(Clock::now() - submitted).count();
+                spin_for(std::chrono::microseconds(100));
+                started.fetch_add(1);
+            };
+            if (setup == 1) pool.post(light, task);
+            else pool.post(task);
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        while (started.load() < light_tasks) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        pool.cancel_all();
+
+        print_percentiles(setup == 0 ? "one FIFO queue" : setup == 1 ? "both tenants" : "flood tenant", wait_us);
+    }
+}
+
+// =========================================
+// SUITE: classes
+// 100 tasks that may only run one at a time (2ms each, e.g. a single DB
+// connection) plus 2000 x 100us unthrottled tasks, 4 workers: the cap done
+// with a mutex inside the task versus a task class with max_concurrent = 1
+// =========================================
+static void bench_classes() {
+    const int throttled = 100, free_tasks = 2000;
+    std::cout << "\n[classes] " << throttled << " x 2ms capped at 1 + " << free_tasks << " x 100us free, 4 workers (ms)\n";
+    std::cout << std::setw(16) << "setup" << std::setw(12) << "free done" << std::setw(12) << "all done" << "\n";
+
+    for (int setup = 0; setup < 2; ++setup) {
+        ThreadPool pool(4);
+        TaskClass db = pool.task_class("db", TaskClassLimits{1, 0, 1});
+        std::mutex connection;
+        std::atomic<int> capped_left{throttled}, free_left{free_tasks};
+
+        auto start = Clock::now();
+        for (int i = 0; i < throttled; ++i) {
+            if (setup == 0) {
+                pool.post([&] {
+                    std::lock_guard<std::mutex> lock(connection);
+                    spin_for(std::chrono::microseconds(2000));
+                    capped_left.fetch_sub(1);
+                });
+            } else {
+                pool.post(db, [&] { spin_for(std::chrono::microseconds(2000)); capped_left.fetch_sub(1); });
+            }
+        }
+        for (int i = 0; i < free_tasks; ++i) {
+            pool.post([&] { spin_for(std::chrono::microseconds(100)); free_left.fetch_sub(1); });
+        }
+
+        double free_done = 0;
+        while (capped_left.load() > 0 || free_left.load() > 0) {
+            if (free_done == 0 && free_left.load() == 0) free_done = seconds_since(start);
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        if (free_done == 0) free_done = seconds_since(start);
+
+        std::cout << std::setw(16) << (setup == 0 ? "mutex in task" : "task class") << std::fixed << std::setprecision(1)
+                  << std::setw(12) << free_done * 1e3 << std::setw(12) << seconds_since(start) * 1e3 << "\n";
+    }
+}
+
+// =========================================
+// SUITE: timer
+// 200k post_after() timers (200..300ms) on 4 workers: insert and cancel cost,
+// then lateness of the half left to fire. Last line: 200 delays of 20ms done
+// as sleep_for() inside tasks versus post_after().
+// =========================================
+static void bench_timer() {
+    const int timers = 200000;
+    ThreadPool pool(4);
+    std::mt19937 rng(42);
+    std::vector<Clock::time_point> due(timers);
+    std::vector<double> late_us(timers, -1);
+    std::vector<TimerHandle> handles(timers);
+    std::atomic<int> fired{0};
+
+    auto start = Clock::now();
+    for (int i = 0; i < timers; ++i) {
+        auto delay = std::chrono::microseconds(200000 + rng() % 100000);
+        due[i] = Clock::now() + delay;
+        handles[i] = pool.post_after(delay, [&, i] {
+            late_us[i] = std::chrono::duration<double, std::micro>(Clock::now() - due[i]).count();
+            fired.fetch_add(1);
+        });
+    }
+    double insert_ns = seconds_since(start) * 1e9 / timers;
+
+    start = Clock::now();
+    int cancelled = 0;
+    for (int i = 0; i < timers; i += 2) cancelled += pool.cancel_timer(handles[i]);
+    double cancel_ns = seconds_since(start) * 1e9 / (timers / 2);
+
+    while (pool.get_timers_pending() > 0 || fired.load() < timers - cancelled) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    late_us.erase(std::remove(late_us.begin(), late_us.end(), -1.0), late_us.end());
+
+    std::cout << "\n[timer] " << timers << " timers, 4 workers\n";
+    std::cout << std::fixed << std::setprecision(1) << "  insert " << insert_ns << " ns, cancel " << cancel_ns
+              << " ns (" << cancelled << " cancelled before firing)\n";
+    std::cout << std::setw(16) << "lateness (us)" << std::setw(10) << "p50" << std::setw(10) << "p90"
+              << std::setw(10) << "p99" << std::setw(12) << "max" << "\n";
+    print_percentiles("post_after", late_us);
+
+    const int delayed = 200;
+    std::atomic<int> left{delayed};
+    start = Clock::now();
+    for (int i = 0; i < delayed; ++i) {
+        pool.post([&] { std::this_thread::sleep_for(std::chrono::milliseconds(20)); left.fetch_sub(1); });
+    }
+    while (left.load() > 0) std::this_thread::sleep_for(std::chrono::microseconds(200));
+    double sleeping = seconds_since(start) * 1e3;
+
+    left = delayed;
+    start = Clock::now();
+    for (int i = 0; i < delayed; ++i) {
+        pool.post_after(std::chrono::milliseconds(20), [&] { left.fetch_sub(1); });
+    }
+    while (left.load() > 0) std::this_thread::sleep_for(std::chrono::microseconds(200));
+    std::cout << "  " << delayed << " x 20ms delays: sleep_for in task " << std::setprecision(1) << sleeping
+              << " ms, post_after " << seconds_since(start) * 1e3 << " ms\n";
+}
+
+// =========================================
+// SUITE: io
+// 400 socket reads waiting at once (then one byte written to each) and
+// 10000 timeouts of 10ms in flight, 4 workers: AsyncIo on io_uring, AsyncIo
+// on epoll, and plain blocking calls on the Executor's blocking pool
+// =========================================
+static void bench_io() {
+    const int sockets = 400, timeouts = 10000;
+    const auto delay = std::chrono::milliseconds(10);
+    std::cout << "\n[io] " << sockets << " pending recv, " << timeouts << " x 10ms timeouts (ms)\n";
+    std::cout << std::setw(16) << "setup" << std::setw(12) << "recv" << std::setw(12) << "timeouts"
+              << std::setw(10) << "threads" << std::setw(12) << "per batch" << "\n";
+
+    for (int setup = 0; setup < 3; ++setup) {
+        std::vector<int> pairs(2 * sockets);
+        for (int i = 0; i < sockets; ++i) socketpair(AF_UNIX, SOCK_STREAM, 0, &pairs[2 * i]);
+        std::vector<char> bufs(sockets);
+        double recv_ms = 0, timeout_ms = 0, per_batch = 0;
+        size_t threads = 0;
+
+        if (setup < 2) {
+            ThreadPool pool(4);
+            AsyncIo io(pool, 1024, setup == 1);
+            std::vector<PoolFuture<long>> pending;
+            auto start = Clock::now();
+            for (int i = 0; i < sockets; ++i) pending.push_back(io.recv(pairs[2 * i], &bufs[i], 1));
+            for (int i = 0; i < sockets; ++i) send(pairs[2 * i + 1], "x", 1, 0);
+            for (auto& f : pending) f.get();
+            recv_ms = seconds_since(start) * 1e3;
+
+            pending.clear();
+            start = Clock::now();
+            for (int i = 0; i < timeouts; ++i) pending.push_back(io.timeout(delay));
+            for (auto& f : pending) f.get();
+            timeout_ms = seconds_since(start) * 1e3;
+            threads = pool.get_workers_count() + 1;
+            per_batch = (double)io.get_completed() / std::max<uint64_t>(1, io.get_batches());
+        } else {
+            ExecutorOptions options;
+            options.cpu_threads = 4;
+            Executor exec(options);
+            std::atomic<int> left{sockets};
+            std::atomic<size_t> peak{0};
+            auto record = [&] {
+                size_t now = exec.get_workers_count(), seen = peak.load();
+                while (now > seen && !peak.compare_exchange_weak(seen, now)) {}
+            };
+            auto start = Clock::now();
+            for (int i = 0; i < sockets; ++i) {
+                exec.post_blocking([&, i] { record(); recv(pairs[2 * i], &bufs[i], 1, 0); left.fetch_sub(1); });
+            }
+            for (int i = 0; i < sockets; ++i) send(pairs[2 * i + 1], "x", 1, 0);
+            while (left.load() > 0) std::this_thread::sleep_for(std::chrono::microseconds(200));
+            recv_ms = seconds_since(start) * 1e3;
+
+            left = timeouts;
+            start = Clock::now();
+            for (int i = 0; i < timeouts; ++i) {
+                exec.post_blocking([&] { record(); std::this_thread::sleep_for(delay); left.fetch_sub(1); });
+            }
+            while (left.load() > 0) std::this_thread::sleep_for(std::chrono::microseconds(200));
+            timeout_ms = seconds_since(start) * 1e3;
+            threads = peak.load();
+        }
+        for (int fd : pairs) close(fd);
+
+        const char* label = setup == 0 ? "io_uring" : setup == 1 ? "epoll" : "blocking pool";
+        std::cout << std::setw(16) << label << std::fixed << std::setprecision(1)
+                  << std::setw(12) << recv_ms << std::setw(12) << timeout_ms << std::setw(10) << threads;
+        if (setup < 2) std::cout << std::setw(12) << per_batch;
+        std::cout << "\n";
+    }
+}
+
+// =========================================
+// SUITE: sort
+// std::sort vs parallel_sort and std::inclusive_scan vs parallel_inclusive_scan
+// on 10^6.. elements, then parallel_sort scaling over worker counts.
+// The largest size is 10^(argv[2]), default 7 and at least 6: 10^8 and 10^9 ints need
+// 0.8 GB and 8 GB including the sort buffer, so they are opt-in.
+// =========================================
+static void bench_sort(int max_exp) {
+    max_exp = std::max(max_exp, 6);  // The scaling table sorts the largest size
+    std::cout << "\n[sort] random ints, 4 workers (ms)\n";
+    std::cout << std::setw(12) << "n" << std::setw(12) << "std::sort" << std::setw(16) << "parallel_sort"
+              << std::setw(12) << "std::scan" << std::setw(16) << "parallel_scan" << "\n";
+
+    std::mt19937 rng(42);
+    ThreadPool pool(4);
+    std::vector<int> largest;
+    size_t n = 1000000;
+    for (int e = 6; e <= max_exp; ++e, n *= 10) {
+        std::vector<int> data(n);
+        for (auto& x : data) x = (int)rng();
+        std::vector<int> work = data;
+        std::cout << std::setw(12) << n << std::fixed << std::setprecision(1);
+
+        auto start = Clock::now();
+        std::sort(work.begin(), work.end());
+        std::cout << std::setw(12) << seconds_since(start) * 1e3;
+
+        std::vector<int> sorted = work;
+        work = data;
+        start = Clock::now();
+        parallel_sort(pool, work.begin(), work.end());
+        double ms = seconds_since(start) * 1e3;
+        std::cout << std::setw(16) << (work == sorted ? ms : -1.0);
+
+        // Unsigned, so the running sums wrap instead of overflowing
+        std::vector<unsigned> in(data.begin(), data.end()), out(n), expected(n);
+        start = Clock::now();
+        std::inclusive_scan(in.begin(), in.end(), expected.begin());
+        std::cout << std::setw(12) << seconds_since(start) * 1e3;
+
+        start = Clock::now();
+        parallel_inclusive_scan(pool, in.begin(), in.end(), out.begin());
+        ms = seconds_since(start) * 1e3;
+        std::cout << std::setw(16) << (out == expected ? ms : -1.0) << "\n";
+
+        if (e == max_exp) largest = std::move(data);
+    }
+
+    std::cout << "  parallel_sort of " << largest.size() << " by workers (ms)\n";
+    for (size_t workers : {1, 2, 4, 8}) {
+        ThreadPool scaling(workers);
+        std::vector<int> work = largest;
+        auto start = Clock::now();
+        parallel_sort(scaling, work.begin(), work.end());
+        std::cout << std::setw(12) << workers << std::fixed << std::setprecision(1)
+                  << std::setw(12) << seconds_since(start) * 1e3 << "\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string suite = argc > 1 ? argv[1] : "all";
+
+    if (suite == "all" || suite == "queue") bench_queue();
+    if (suite == "all" || suite == "steal") bench_steal();
+    if (suite == "all" || suite == "latency") bench_latency();
+    if (suite == "all" || suite == "alloc") bench_alloc();
+    if (suite == "all" || suite == "post") bench_post();
+    if (suite == "all" || suite == "bulk") bench_bulk();
+    if (suite == "all" || suite == "batch") bench_batch();
+    if (suite == "all" || suite == "numa") bench_numa();
+    if (suite == "all" || suite == "priority") bench_priority();
+    if (suite == "all" || suite == "deadline") bench_deadline();
+    if (suite == "all" || suite == "group") bench_group();
+    if (suite == "all" || suite == "parfor") bench_parfor();
+    if (suite == "all" || suite == "graph") bench_graph();
+    if (suite == "all" || suite == "then") bench_then();
+#ifdef THREAD_POOL_COROUTINES
+    if (suite == "all" || suite == "coro") bench_coro();
+#endif
+    if (suite == "all" || suite == "blocking") bench_blocking();
+    if (suite == "all" || suite == "tenants") bench_tenants();
+    if (suite == "all" || suite == "classes") bench_classes();
+    if (suite == "all" || suite == "timer") bench_timer();
+    if (suite == "all" || suite == "io") bench_io();
+    if (suite == "all" || suite == "sort") bench_sort(argc > 2 ? std::atoi(argv[2]) : 7);
+
+    return 0;
+}
@@ -4,7 +4,14 @@
 #include <thread>
 #include <atomic>
 #include <string>
-#include "ThreadPool.h"
+#include <cerrno>
+#include <cstdlib>
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <numeric>
+#include <future>
+#include "Executor.h"
 #include "httplib.h" 
 
 // --- GLOBAL STATS ---
@@ -28,7 +35,14 @@ int main() {
         cores = 4; // Fallback to 4 threads if hardware detection fails
     }
     
-    ThreadPool pool(cores);
+    // heavy_task mostly sleeps, so it runs on the elastic blocking pool and
+    // leaves the 'cores' CPU workers free
+    ExecutorOptions options;
+    options.cpu_threads = cores;
+    options.blocking_min_threads = cores;
+    options.blocking_max_threads = cores * 16;
+    Executor executor(options);
+    ThreadPool& pool = executor.blocking_pool();
     int total_tasks = 5000; 
     g_total = total_tasks;
 
@@ -162,6 +176,7 @@ int main() {
                             <div class="card">
                                 <div class="card-title">Stress Test</div>
                                 <button class="btn-chaos" onclick="injectChaos()">INJECT LOAD</button>
+                                <button class="btn-chaos" style="margin-top: 10px;" onclick="abortBacklog()">ABORT BACKLOG</button>
                                 <p style="font-size: 0.7rem; color: #666; text-align: center; margin-top: 10px;">Warning: High CPU Usage</p>
                             </div>
 
@@ -293,6 +308,13 @@ int main() {
                             });
                         }
 
+                        function abortBacklog() {
+                            fetch('/cancel').then(r => r.text()).then(n => {
+                                showToast("BACKLOG ABORTED: -" + n + " TASKS");
+                                log("Cancelled " + n + " queued tasks", "warn");
+                            });
+                        }
+
                         let lastCompleted = 0;
 
                         setInterval(() => {
@@ -338,10 +360,38 @@ int main() {
             res.set_content(json, "application/json");
         });
 
-        // API: Inject Chaos
-        svr.Get("/inject", [&pool](const httplib::Request&, httplib::Response& res) {
-            for(int i = 0; i < 1000; ++i) pool.submit(heavy_task, i);
-            g_total += 1000; 
+        // API: Inject Chaos (e.g. /inject?tenant=acme). A tagged burst waits in
+        // its tenant's queue, so one client spamming it can't starve the others.
+        // Names are 1-32 of [A-Za-z0-9_-]; tenants live as long as the pool,
+        // so past PoolOptions::max_tenants new names are refused.
+        svr.Get("/inject", [&pool](const httplib::Request& req, httplib::Response& res) {
+            if (req.has_param("tenant")) {
+                std::string name = req.get_param_value("tenant");
+                bool valid = !name.empty() && name.size() <= 32 &&
+                             std::all_of(name.begin(), name.end(), [](unsigned char c) {
+                                 return std::isalnum(c) || c == '_' || c == '-';
+                             });
+                if (!valid) {
+                    res.status = 400;
+                    res.set_content("tenant must be 1-32 of [A-Za-z0-9_-]", "text/plain");
+                    return;
+                }
+                Tenant tenant;
+                try {
+                    tenant = pool.tenant(name);
+                } catch (const std::length_error&) {
+                    res.status = 429;
+                    res.set_content("too many tenants", "text/plain");
+                    return;
+                }
+                for (int i = 0; i < 1000; ++i) pool.post(tenant, heavy_task, i);
+            } else {
+                // One queue operation and one wake-up round for the whole burst
+                std::vector<int> ids(1000);
+                std::iota(ids.begin(), ids.end(), 0);
+                pool.post_bulk(ids.begin(), ids.end(), heavy_task);
+            }
+            g_total += 1000;
             res.set_content("OK", "text/plain");
         });
 
@@ -354,6 +404,30 @@ int main() {
             res.set_content("OK", "text/plain");
         });
 
+        // API: Drop every queued task (the client gave up on the burst)
+        svr.Get("/cancel", [&pool](const httplib::Request&, httplib::Response& res) {
+            size_t removed = pool.cancel_all();
+            g_total -= (int)removed;
+            res.set_content(std::to_string(removed), "text/plain");
+        });
+
+        // API: Resize the pool (e.g. /resize?n=8). resize() clamps n to the pool's bounds.
+        svr.Get("/resize", [&pool](const httplib::Request& req, httplib::Response& res) {
+            if (req.has_param("n")) {
+                const std::string value = req.get_param_value("n");
+                char* end = nullptr;
+                errno = 0;
+                long n = std::strtol(value.c_str(), &end, 10);
+                if (value.empty() || *end != '\0' || errno == ERANGE || n <= 0) {
+                    res.status = 400;
+                    res.set_content("n must be a positive integer", "text/plain");
+                    return;
+                }
+                pool.resize((size_t)n);
+            }
+            res.set_content("OK", "text/plain");
+        });
+
         std::cout << "Server listening on http://localhost:8080" << std::endl;
         svr.listen("0.0.0.0", 8080);
     });
@@ -361,20 +435,25 @@ int main() {
     // 3. Submit Initial Tasks
     std::this_thread::sleep_for(std::chrono::seconds(2)); 
     for(int i = 0; i < total_tasks; ++i) {
-        pool.submit(heavy_task, i);
+        executor.post_blocking(heavy_task, i); // Result is never read, skip the future
     }
 
-    // 4. Monitoring Loop
-    while(true) {
-        g_pending = pool.get_tasks_queued();
-        g_workers = pool.get_workers_count();
-        if(g_pending == 0 && g_total > 0) {
-             std::cout << "\n[NEXUS] ALL TASKS COMPLETE. SYSTEM SHUTDOWN IN 3 SECONDS..." << std::endl;
-             std::this_thread::sleep_for(std::chrono::seconds(3));
-             break;
+    // 4. Monitoring: a periodic timer samples the stats, main just waits for the drain
+    std::promise<void> drained;
+    std::future<void> all_done = drained.get_future();
+    std::atomic<bool> reported{false};
+    TimerHandle monitor = executor.cpu_pool().submit_every(std::chrono::milliseconds(500), [&] {
+        g_pending = executor.get_tasks_queued();
+        g_workers = executor.get_workers_count();
+        if (g_pending == 0 && g_total > 0 && !reported.exchange(true)) {
+            drained.set_value();
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
-    }
+    });
+    all_done.wait();
+    executor.cpu_pool().cancel_timer(monitor);
+
+    std::cout << "\n[NEXUS] ALL TASKS COMPLETE. SYSTEM SHUTDOWN IN 3 SECONDS..." << std::endl;
+    std::this_thread::sleep_for(std::chrono::seconds(3));
 
     std::cout << "[NEXUS] OFFLINE." << std::endl;
     server_thread.detach(); 